@@ -1,22 +1,32 @@
-QT       += core gui charts
+QT       += core gui charts concurrent
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
 CONFIG += c++11
 
+TARGET = ProgQt
+
+# aperto da solo (Qt Creator) il progetto compila anche i sorgenti del motore dei dati;
+# dentro dipinti.pro (app/app.pro) si collega invece alla libreria PaintingCatalog
+!catalog_link: CONFIG += catalog_sources
+
 # You can make your code fail to compile if it uses deprecated APIs.
 # In order to do so, uncomment the following line.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
+include($$PWD/catalog.pri)
+
 SOURCES += \
-    main.cpp \
-    mainwindow.cpp
+    $$PWD/main.cpp \
+    $$PWD/mainwindow.cpp \
+    $$PWD/paintingmodel.cpp
 
 HEADERS += \
-    mainwindow.h
+    $$PWD/mainwindow.h \
+    $$PWD/paintingmodel.h
 
 FORMS += \
-    mainwindow.ui
+    $$PWD/mainwindow.ui
 
 # Default rules for deployment.
 qnx: target.path = /tmp/$${TARGET}/bin
@@ -26,4 +36,4 @@ else: unix:!android: target.path = /opt/$${TARGET}/bin
 DISTFILES +=
 
 RESOURCES += \
-    resources.qrc
+    $$PWD/resources.qrc
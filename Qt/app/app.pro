@@ -0,0 +1,6 @@
+# Interfaccia grafica dentro dipinti.pro: lo stesso progetto di ProgQt.pro,
+# collegato alla libreria PaintingCatalog invece di ricompilarne i sorgenti
+
+CONFIG += catalog_link
+
+include(../ProgQt.pro)
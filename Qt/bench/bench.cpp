@@ -0,0 +1,485 @@
+#include <benchmark/benchmark.h>
+#include <QBuffer>
+#include <QFile>
+#include <QMap>
+#include <map>
+#include <memory>
+#include "concurrent_set.hpp"
+#include "dipinto.h"
+#include "facet_index.hpp"
+#include "paintingcatalog.h"
+#include "selection.hpp"
+
+// Cataloghi sintetici derivati da dipinti_uffizi.csv: la riga i del catalogo
+// è la riga (i % n) del dataset con il titolo reso unico da un suffisso.
+//
+// I benchmark che riempiono un set arrivano a 64k elementi perché set::add
+// controlla l'appartenenza con una scansione lineare (costo quadratico);
+// quelli che non costruiscono un set, o che caricano un PaintingCatalog
+// (appartenenza tramite indice hash), arrivano a 10M righe.
+
+typedef set<dipinto, dipinto::equal_dipinto> collezione;
+
+namespace {
+
+// righe del dataset senza intestazione
+const QStringList &righeBase() {
+    static QStringList righe;
+
+    if (righe.isEmpty()) {
+        QFile file(DATASET_CSV);
+        if (!file.open(QIODevice::ReadOnly))
+            qFatal("impossibile aprire %s", DATASET_CSV);
+
+        file.readLine();
+        while (!file.atEnd()) {
+            QString line = file.readLine().trimmed();
+            if (!line.isEmpty())
+                righe.append(line);
+        }
+    }
+
+    return righe;
+}
+
+
+const QVector<QStringList> &campiBase() {
+    static QVector<QStringList> campi;
+
+    if (campi.isEmpty())
+        for (const QString &line : righeBase())
+            campi.append(parseLine(line));
+
+    return campi;
+}
+
+
+dipinto sintetico(int i) {
+    const QVector<QStringList> &base = campiBase();
+    const QStringList &f = base[i % base.size()];
+
+    return dipinto(f[0], f[1], f[2] + " #" + QString::number(i / base.size()), f[3], f[4]);
+}
+
+
+// catalogo di n elementi, costruito una volta sola e riusato dai benchmark
+const collezione &catalogo(int n) {
+    static QMap<int, collezione> cache;
+
+    if (!cache.contains(n)) {
+        collezione c;
+        for (int i = 0; i < n; ++i)
+            c.add(sintetico(i));
+        cache.insert(n, c);
+    }
+
+    return cache[n];
+}
+
+
+// CSV di n righe con intestazione, con gli stessi dipinti di sintetico(0) ... sintetico(n - 1)
+const QByteArray &csvSintetico(int n) {
+    static QMap<int, QByteArray> cache;
+
+    if (!cache.contains(n)) {
+        QByteArray csv = "Scuola,Autore,Soggetto/Titolo,Data,Sala\n";
+        for (int i = 0; i < n; ++i) {
+            dipinto d = sintetico(i);
+            QStringList campi = { d.getScuola(), d.getAutore(), d.getTitolo(), d.getData(), d.getSala() };
+            csv += ("\"" + campi.join("\",\"") + "\"\n").toUtf8();
+        }
+        cache.insert(n, csv);
+    }
+
+    return cache[n];
+}
+
+
+// catalogo dell'applicazione caricato da csvSintetico(n), costruito una volta sola
+const PaintingCatalog &catalogoApp(int n) {
+    static std::map<int, std::unique_ptr<PaintingCatalog>> cache;
+    std::unique_ptr<PaintingCatalog> &c = cache[n];
+
+    if (!c) {
+        QByteArray csv = csvSintetico(n);
+        QBuffer buffer(&csv);
+        buffer.open(QIODevice::ReadOnly);
+        c.reset(new PaintingCatalog());
+        c->load(buffer);
+    }
+
+    return *c;
+}
+
+
+QVector<collezione::handle_type> tutti(const collezione &c) {
+    QVector<collezione::handle_type> sel;
+    for (collezione::size_type i = 0; i < c.getNumElements(); ++i)
+        sel.append(c.handle_at(i));
+
+    return sel;
+}
+
+} // namespace
+
+
+static void BM_SetAdd(benchmark::State &state) {
+    int n = state.range(0);
+    QVector<dipinto> dati;
+    for (int i = 0; i < n; ++i)
+        dati.append(sintetico(i));
+
+    // comprende la cascata di resize dovuta al raddoppio della capacità, non la distruzione del set
+    for (auto _ : state) {
+        collezione *c = new collezione();
+        for (const dipinto &d : dati)
+            c->add(d);
+        benchmark::DoNotOptimize(c->getNumElements());
+
+        state.PauseTiming();
+        delete c;
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+// add è quadratico (scansione lineare per ogni inserimento): oltre 2^14 elementi una misura dura minuti
+BENCHMARK(BM_SetAdd)->RangeMultiplier(4)->Range(1 << 10, 1 << 14);
+
+
+static void BM_SetContains(benchmark::State &state) {
+    int n = state.range(0);
+    const collezione &c = catalogo(n);
+    // metà delle ricerche trova l'elemento, metà no
+    dipinto presente = sintetico(n / 2);
+    dipinto assente = sintetico(n);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(c.contains(presente));
+        benchmark::DoNotOptimize(c.contains(assente));
+    }
+    state.SetItemsProcessed(state.iterations() * 2);
+}
+// limite dato dalla costruzione del catalogo con add, quadratica
+BENCHMARK(BM_SetContains)->RangeMultiplier(4)->Range(1 << 10, 1 << 16);
+
+
+static void BM_SetRemove(benchmark::State &state) {
+    int n = state.range(0);
+    QVector<dipinto> chiavi;
+    for (int i = 0; i < n; i += 16)
+        chiavi.append(sintetico(i));
+
+    // solo le rimozioni: copia e distruzione del set sono fuori dalla misura
+    for (auto _ : state) {
+        state.PauseTiming();
+        collezione *c = new collezione(catalogo(n));
+        state.ResumeTiming();
+
+        for (const dipinto &d : chiavi)
+            c->remove(d);
+        benchmark::DoNotOptimize(c->getNumElements());
+
+        state.PauseTiming();
+        delete c;
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * chiavi.size());
+}
+// limite dato dalla costruzione del catalogo con add, quadratica
+BENCHMARK(BM_SetRemove)->RangeMultiplier(4)->Range(1 << 10, 1 << 16);
+
+
+static void BM_SetResize(benchmark::State &state) {
+    int n = state.range(0);
+
+    // svuota il set per handle: il costo è dominato dai resize di riduzione
+    for (auto _ : state) {
+        state.PauseTiming();
+        collezione *c = new collezione(catalogo(n));
+        state.ResumeTiming();
+
+        while (c->getNumElements() > 0)
+            c->remove_handle(c->handle_at(c->getNumElements() - 1));
+        benchmark::DoNotOptimize(c->capacity());
+
+        state.PauseTiming();
+        delete c;
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+// limite dato dalla costruzione del catalogo con add, quadratica
+BENCHMARK(BM_SetResize)->RangeMultiplier(4)->Range(1 << 10, 1 << 16);
+
+
+static void BM_SetUnion(benchmark::State &state) {
+    int n = state.range(0);
+    collezione a, b;
+    for (int i = 0; i < n; ++i) {
+        a.add(sintetico(i));
+        b.add(sintetico(i + n / 2));
+    }
+
+    for (auto _ : state) {
+        collezione r = a + b;
+        benchmark::DoNotOptimize(r.getNumElements());
+    }
+    state.SetItemsProcessed(state.iterations() * 2 * n);
+}
+// unione e intersezione sono quadratiche come add
+BENCHMARK(BM_SetUnion)->RangeMultiplier(4)->Range(1 << 10, 1 << 14);
+
+
+static void BM_SetIntersection(benchmark::State &state) {
+    int n = state.range(0);
+    collezione a, b;
+    for (int i = 0; i < n; ++i) {
+        a.add(sintetico(i));
+        b.add(sintetico(i + n / 2));
+    }
+
+    for (auto _ : state) {
+        collezione r = a - b;
+        benchmark::DoNotOptimize(r.getNumElements());
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+// unione e intersezione sono quadratiche come add
+BENCHMARK(BM_SetIntersection)->RangeMultiplier(4)->Range(1 << 10, 1 << 14);
+
+
+static void BM_FilterOut(benchmark::State &state) {
+    const collezione &c = catalogo(state.range(0));
+    dipinto::ricerca_titolo filtro("madonna");
+
+    for (auto _ : state) {
+        collezione r = filter_out(c, filtro);
+        benchmark::DoNotOptimize(r.getNumElements());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_FilterOut)->RangeMultiplier(4)->Range(1 << 10, 1 << 16);
+
+
+// stesso filtro di BM_FilterOut, restituito come selection di handle invece che come set
+static void BM_Seleziona(benchmark::State &state) {
+    const collezione &c = catalogo(state.range(0));
+    dipinto::ricerca_titolo filtro("madonna");
+
+    for (auto _ : state) {
+        selection r = seleziona(c, filtro);
+        benchmark::DoNotOptimize(r.count());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_Seleziona)->RangeMultiplier(4)->Range(1 << 10, 1 << 16);
+
+
+static void BM_ParseLine(benchmark::State &state) {
+    const QStringList &righe = righeBase();
+    int n = state.range(0);
+
+    for (auto _ : state) {
+        for (int i = 0; i < n; ++i)
+            benchmark::DoNotOptimize(parseLine(righe[i % righe.size()]));
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_ParseLine)->RangeMultiplier(10)->Range(1000, 10000000)->Unit(benchmark::kMillisecond);
+
+
+// caricamento reale dell'applicazione: lettore_csv, costruzione dei dipinti (normalizzazione
+// del titolo, impronta) e PaintingCatalog::inserisci con gli indici; la distruzione non è misurata
+static void BM_CatalogLoad(benchmark::State &state) {
+    QByteArray csv = csvSintetico(state.range(0));
+
+    for (auto _ : state) {
+        QBuffer buffer(&csv);
+        buffer.open(QIODevice::ReadOnly);
+        PaintingCatalog *c = new PaintingCatalog();
+        c->load(buffer);
+        benchmark::DoNotOptimize(c->size());
+
+        state.PauseTiming();
+        delete c;
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+    state.SetBytesProcessed(state.iterations() * csv.size());
+}
+BENCHMARK(BM_CatalogLoad)->RangeMultiplier(10)->Range(1000, 10000000)->Unit(benchmark::kMillisecond);
+
+
+// ricerca dell'applicazione: indice dei trigrammi e verifica dei candidati
+static void BM_CatalogFiltra(benchmark::State &state) {
+    const PaintingCatalog &c = catalogoApp(state.range(0));
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(c.filtra("madonna").count());
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_CatalogFiltra)->RangeMultiplier(10)->Range(1000, 1000000);
+
+
+static void BM_SetupStr(benchmark::State &state) {
+    const QVector<QStringList> &campi = campiBase();
+    int n = state.range(0);
+
+    for (auto _ : state) {
+        for (int i = 0; i < n; ++i)
+            benchmark::DoNotOptimize(setupStr(campi[i % campi.size()][3]));
+    }
+    state.SetItemsProcessed(state.iterations() * n);
+}
+BENCHMARK(BM_SetupStr)->RangeMultiplier(10)->Range(1000, 10000000)->Unit(benchmark::kMillisecond);
+
+
+static void BM_ConteggioScuole(benchmark::State &state) {
+    const collezione &c = catalogo(state.range(0));
+    QVector<collezione::handle_type> sel = tutti(c);
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(conteggio(c, sel, dipinto::chiave_scuola()));
+    state.SetItemsProcessed(state.iterations() * sel.size());
+}
+BENCHMARK(BM_ConteggioScuole)->RangeMultiplier(4)->Range(1 << 10, 1 << 16);
+
+
+static void BM_ConteggioSecoli(benchmark::State &state) {
+    const collezione &c = catalogo(state.range(0));
+    QVector<collezione::handle_type> sel = tutti(c);
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(conteggio(c, sel, dipinto::chiave_secolo()));
+    state.SetItemsProcessed(state.iterations() * sel.size());
+}
+BENCHMARK(BM_ConteggioSecoli)->RangeMultiplier(4)->Range(1 << 10, 1 << 16);
+
+
+// stessi conteggi di BM_ConteggioScuole tramite indice per scuola: una intersezione per scuola
+static void BM_FaccetteScuole(benchmark::State &state) {
+    const collezione &c = catalogo(state.range(0));
+    facet_index<dipinto, dipinto::chiave_scuola> scuole;
+    for (collezione::size_type i = 0; i < c.getNumElements(); ++i)
+        scuole.insert(c.handle_at(i), c[i]);
+    selection sel = seleziona_tutti(c);
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(scuole.counts(sel));
+    state.SetItemsProcessed(state.iterations() * c.getNumElements());
+}
+BENCHMARK(BM_FaccetteScuole)->RangeMultiplier(4)->Range(1 << 10, 1 << 16);
+
+
+// combinazione di due filtri come selection: ricerca AND scuola, poi OR e differenza
+static void BM_SelectionOps(benchmark::State &state) {
+    const collezione &c = catalogo(state.range(0));
+    selection madonne = seleziona(c, dipinto::ricerca_titolo("madonna"));
+    selection fiorentini = seleziona(c, [](const dipinto &d) { return d.getScuola() == "fiorentina"; });
+
+    for (auto _ : state) {
+        selection entrambi = madonne & fiorentini;
+        selection uno = madonne | fiorentini;
+        benchmark::DoNotOptimize((uno - entrambi).count());
+    }
+    state.SetItemsProcessed(state.iterations() * c.getNumElements());
+}
+BENCHMARK(BM_SelectionOps)->RangeMultiplier(4)->Range(1 << 10, 1 << 16);
+
+
+static void BM_TopK(benchmark::State &state) {
+    // n categorie distinte, come le scuole di cataloghi uniti
+    QMap<QString, int> conteggi;
+    for (int i = 0; i < state.range(0); ++i)
+        conteggi.insert(QString("scuola %1").arg(i), (i * 7919) % 1000 + 1);
+
+    for (auto _ : state)
+        benchmark::DoNotOptimize(topK(conteggi, 10));
+    state.SetItemsProcessed(state.iterations() * conteggi.size());
+}
+BENCHMARK(BM_TopK)->RangeMultiplier(10)->Range(100, 1000000);
+
+
+// contesa tra thread su concurrent_set: ogni thread inserisce e cerca elementi diversi
+// di un insieme di 2^18 dipinti; dopo il primo giro gli inserimenti trovano duplicati
+typedef concurrent_set<dipinto, dipinto::equal_dipinto, dipinto::hash_dipinto> collezione_concorrente;
+
+static QVector<dipinto> creaDatiConcorrenti() {
+    QVector<dipinto> dati;
+    for (int i = 0; i < (1 << 18); ++i)
+        dati.append(sintetico(i));
+
+    return dati;
+}
+
+// chiamata da tutti i thread: l'inizializzazione della statica locale è sicura tra thread
+static const QVector<dipinto> &datiConcorrenti() {
+    static const QVector<dipinto> dati = creaDatiConcorrenti();
+
+    return dati;
+}
+
+static collezione_concorrente *condiviso = nullptr;
+
+static void BM_ConcurrentAdd(benchmark::State &state) {
+    const QVector<dipinto> &dati = datiConcorrenti();
+
+    if (state.thread_index() == 0)
+        condiviso = new collezione_concorrente();
+
+    int i = state.thread_index();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(condiviso->add(dati[i % dati.size()]));
+        i += state.threads();
+    }
+    state.SetItemsProcessed(state.iterations());
+
+    if (state.thread_index() == 0) {
+        delete condiviso;
+        condiviso = nullptr;
+    }
+}
+BENCHMARK(BM_ConcurrentAdd)->ThreadRange(1, 64)->UseRealTime();
+
+
+static void BM_ConcurrentContains(benchmark::State &state) {
+    const QVector<dipinto> &dati = datiConcorrenti();
+
+    if (state.thread_index() == 0) {
+        condiviso = new collezione_concorrente();
+        for (int i = 0; i < dati.size(); i += 2)
+            condiviso->add(dati[i]);
+    }
+
+    int i = state.thread_index();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(condiviso->contains(dati[i % dati.size()]));
+        i += state.threads();
+    }
+    state.SetItemsProcessed(state.iterations());
+
+    if (state.thread_index() == 0) {
+        delete condiviso;
+        condiviso = nullptr;
+    }
+}
+BENCHMARK(BM_ConcurrentContains)->ThreadRange(1, 64)->UseRealTime();
+
+
+static void BM_ConcurrentFreeze(benchmark::State &state) {
+    const QVector<dipinto> &dati = datiConcorrenti();
+    collezione_concorrente c;
+    for (const dipinto &d : dati)
+        c.add(d);
+
+    for (auto _ : state) {
+        collezione s;
+        c.freeze(s);
+        benchmark::DoNotOptimize(s.getNumElements());
+    }
+    state.SetItemsProcessed(state.iterations() * dati.size());
+}
+BENCHMARK(BM_ConcurrentFreeze)->Unit(benchmark::kMillisecond);
+
+
+BENCHMARK_MAIN();
@@ -0,0 +1,17 @@
+QT = core
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = bench
+
+# Google Benchmark (https://github.com/google/benchmark)
+LIBS += -lbenchmark -lpthread
+
+# percorso del dataset da cui vengono derivati i cataloghi sintetici
+DEFINES += DATASET_CSV=\\\"$$PWD/../dipinti_uffizi.csv\\\"
+
+include(../catalog.pri)
+
+SOURCES += \
+    bench.cpp
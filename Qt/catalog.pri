@@ -0,0 +1,24 @@
+# Impostazioni comuni del motore dei dati (solo QtCore): la libreria PaintingCatalog
+# è compilata da catalog/catalog.pro, a cui si collegano interfaccia grafica,
+# programma batch e benchmark dentro dipinti.pro. Con CONFIG += catalog_sources
+# (ProgQt.pro aperto da solo) i sorgenti sono compilati nel progetto stesso
+
+QT *= core
+
+# misure dei percorsi critici, attive anche in produzione; qmake CONFIG+=no_profilo le elimina
+!no_profilo: DEFINES += DIPINTI_PROFILO
+
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+catalog_lib|catalog_sources {
+    include($$PWD/catalog_sources.pri)
+} else {
+    # la libreria si trova nella cartella di compilazione di catalog/ (vedi dipinti.pro)
+    CATALOG_LIB = $$shadowed($$PWD/catalog)
+
+    LIBS += -L$$CATALOG_LIB -lPaintingCatalog
+
+    win32-msvc*: PRE_TARGETDEPS += $$CATALOG_LIB/PaintingCatalog.lib
+    else: PRE_TARGETDEPS += $$CATALOG_LIB/libPaintingCatalog.a
+}
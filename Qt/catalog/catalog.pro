@@ -0,0 +1,10 @@
+QT = core
+
+TEMPLATE = lib
+CONFIG += c++11 staticlib catalog_lib
+
+TARGET = PaintingCatalog
+# percorso fisso, senza sottocartelle debug/release, per i progetti che si collegano alla libreria
+DESTDIR = $$shadowed($$PWD)
+
+include(../catalog.pri)
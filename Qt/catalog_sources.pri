@@ -0,0 +1,21 @@
+# Sorgenti del motore dei dati, compilati dalla libreria (catalog/catalog.pro)
+# o direttamente da ProgQt.pro quando è aperto da solo (vedi catalog.pri)
+
+SOURCES += \
+    $$PWD/dipinto.cpp \
+    $$PWD/lettore_csv.cpp \
+    $$PWD/paintingcatalog.cpp \
+    $$PWD/profilo.cpp \
+    $$PWD/ricerca.cpp
+
+HEADERS += \
+    $$PWD/concurrent_set.hpp \
+    $$PWD/dipinto.h \
+    $$PWD/facet_index.hpp \
+    $$PWD/lettore_csv.h \
+    $$PWD/paintingcatalog.h \
+    $$PWD/profilo.h \
+    $$PWD/ricerca.h \
+    $$PWD/selection.hpp \
+    $$PWD/set.hpp \
+    $$PWD/versioned_set.hpp
@@ -0,0 +1,16 @@
+QT = core concurrent
+
+CONFIG += c++11 console
+CONFIG -= app_bundle
+
+TARGET = dipinti-batch
+
+include(../catalog.pri)
+
+SOURCES += \
+    main.cpp
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
@@ -0,0 +1,300 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QFile>
+#include <QHash>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMap>
+#include <QScopedPointer>
+#include <QTextStream>
+#include <QThread>
+#include <QThreadPool>
+#include <QtConcurrent>
+#include <functional>
+#include "concurrent_set.hpp"
+#include "dipinto.h"
+#include "lettore_csv.h"
+
+// Programma batch: legge uno o più CSV in streaming, applica i filtri e
+// stampa i conteggi per ciascun raggruppamento richiesto.
+// Mentre i thread elaborano un gruppo di blocchi il thread principale legge il successivo:
+// in memoria restano i conteggi e al massimo due blocchi di righe per thread
+// (più i dipinti distinti con --distinct).
+
+namespace {
+
+// raggruppamento -> (chiave -> conteggio)
+typedef QHash<QString, QHash<QString, qint64>> conteggi;
+
+struct filtri {
+    QString titolo, scuola, secolo, sala;
+};
+
+// dipinti già contati con --distinct, condivisi tra i thread
+typedef concurrent_set<dipinto, dipinto::equal_dipinto, dipinto::hash_dipinto> visti_set;
+
+// le chiavi del catalogo applicate ai campi della riga, senza costruire il dipinto
+typedef std::function<QString(const QStringList&)> chiave;
+
+// raggruppamenti disponibili: nome -> chiave di raggruppamento del catalogo
+const QMap<QString, chiave> &chiavi() {
+    static const QMap<QString, chiave> c {
+        {"scuola", dipinto::chiave_scuola()},
+        {"secolo", dipinto::chiave_secolo()},
+        {"sala", dipinto::chiave_sala()},
+        {"autore", dipinto::chiave_autore()}
+    };
+
+    return c;
+}
+
+
+// elabora un blocco di righe e restituisce i conteggi parziali
+conteggi elabora(const QStringList &blocco, const filtri &f, const QStringList &gruppi, visti_set *visti) {
+    conteggi parziali;
+    dipinto::ricerca_titolo ricerca(f.titolo);
+    QVector<chiave> chiaviGruppi;
+    for (const QString &g : gruppi)
+        chiaviGruppi.append(chiavi().value(g));
+
+    QStringList campi;
+    for (const QString &line : blocco) {
+        if (!lettore_csv::dividi(line, campi))
+            continue;
+
+        if (!f.scuola.isEmpty() && campi[CAMPO_SCUOLA].compare(f.scuola, Qt::CaseInsensitive) != 0)
+            continue;
+        if (!f.sala.isEmpty() && campi[CAMPO_SALA].compare(f.sala, Qt::CaseInsensitive) != 0)
+            continue;
+        if (!f.secolo.isEmpty() && dipinto::chiave_secolo()(campi) != f.secolo)
+            continue;
+
+        // il dipinto (titolo normalizzato, impronta) serve solo alla ricerca e a --distinct
+        if (!f.titolo.isEmpty() || visti) {
+            dipinto d(campi[CAMPO_SCUOLA], campi[CAMPO_AUTORE], campi[CAMPO_TITOLO], campi[CAMPO_DATA], campi[CAMPO_SALA]);
+
+            if (!f.titolo.isEmpty() && !ricerca(d))
+                continue;
+            if (visti && !visti->add(d))
+                continue;
+        }
+
+        for (int i = 0; i < gruppi.size(); ++i)
+            ++parziali[gruppi[i]][chiaviGruppi[i](campi)];
+    }
+
+    return parziali;
+}
+
+
+// funtore per QtConcurrent: result_type indica il tipo restituito da ciascun blocco
+struct elabora_blocco {
+    typedef conteggi result_type;
+
+    filtri f;
+    QStringList gruppi;
+    visti_set *visti;
+
+    elabora_blocco(const filtri &f1, const QStringList &g, visti_set *v) : f(f1), gruppi(g), visti(v) {}
+
+    conteggi operator()(const QStringList &blocco) const {
+        return elabora(blocco, f, gruppi, visti);
+    }
+};
+
+
+// legge i file uno dopo l'altro, a blocchi di righe
+class lettura {
+    QStringList _files;
+    int _prossimo = 0;
+    QFile _file;
+    QScopedPointer<lettore_csv> _lettore;
+    QString _errore;
+
+    // apre il file successivo se quello corrente è finito; false a fine input o in caso di errore
+    bool disponibile() {
+        while (!_lettore || _lettore->atEnd()) {
+            if (_prossimo >= _files.size())
+                return false;
+
+            _lettore.reset();
+            _file.close();
+            _file.setFileName(_files[_prossimo++]);
+            if (!_file.open(QIODevice::ReadOnly)) {
+                _errore = _file.fileName() + ": " + _file.errorString();
+                return false;
+            }
+            _lettore.reset(new lettore_csv(_file));
+        }
+
+        return true;
+    }
+
+public:
+    explicit lettura(const QStringList &files) : _files(files) {}
+
+    QString errorString() const {
+        return _errore;
+    }
+
+    // al massimo n blocchi di righePerBlocco righe, vuoto a fine input
+    QVector<QStringList> blocchi(int n, int righePerBlocco) {
+        QVector<QStringList> risultato;
+
+        while (risultato.size() < n && disponibile()) {
+            QStringList blocco;
+            while (blocco.size() < righePerBlocco && disponibile())
+                blocco += _lettore->righe(righePerBlocco - blocco.size());
+            if (!blocco.isEmpty())
+                risultato.append(blocco);
+        }
+
+        return risultato;
+    }
+};
+
+
+void unisci(conteggi &totale, const conteggi &parziali) {
+    for (auto g = parziali.begin(); g != parziali.end(); ++g)
+        for (auto k = g.value().begin(); k != g.value().end(); ++k)
+            totale[g.key()][k.key()] += k.value();
+}
+
+
+void scriviCsv(QTextStream &out, const conteggi &totale, const QStringList &gruppi) {
+    out << "raggruppamento,chiave,conteggio\n";
+
+    for (const QString &g : gruppi) {
+        QStringList chiavi = totale.value(g).keys();
+        chiavi.sort();
+
+        for (const QString &k : chiavi) {
+            QString campo = k;
+            campo.replace("\"", "\"\"");
+            out << g << ",\"" << campo << "\"," << totale.value(g).value(k) << "\n";
+        }
+    }
+}
+
+
+void scriviJson(QTextStream &out, const conteggi &totale, const QStringList &gruppi) {
+    QJsonObject radice;
+
+    for (const QString &g : gruppi) {
+        QJsonObject gruppo;
+        const QHash<QString, qint64> &valori = totale.value(g);
+        for (auto k = valori.begin(); k != valori.end(); ++k)
+            gruppo.insert(k.key(), double(k.value()));
+        radice.insert(g, gruppo);
+    }
+
+    out << QJsonDocument(radice).toJson();
+}
+
+} // namespace
+
+
+int main(int argc, char *argv[]) {
+    QCoreApplication a(argc, argv);
+    QCoreApplication::setApplicationName("dipinti-batch");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Conteggi per scuola, secolo, sala o autore su uno o più CSV di dipinti");
+    parser.addHelpOption();
+    parser.addPositionalArgument("file", "CSV da leggere (con riga di intestazione)", "file...");
+
+    QCommandLineOption groupBy(QStringList() << "g" << "group-by", "Raggruppamento: scuola, secolo, sala, autore (ripetibile).", "campo");
+    QCommandLineOption format(QStringList() << "f" << "format", "Formato di uscita: csv o json.", "formato", "csv");
+    QCommandLineOption output(QStringList() << "o" << "output", "File di uscita (default: standard output).", "file");
+    QCommandLineOption titolo("titolo", "Filtro approssimato sul titolo.", "testo");
+    QCommandLineOption scuola("scuola", "Filtro esatto sulla scuola.", "scuola");
+    QCommandLineOption secolo("secolo", "Filtro sul secolo (es. 1500, NaN).", "secolo");
+    QCommandLineOption sala("sala", "Filtro esatto sulla sala.", "sala");
+    QCommandLineOption threads(QStringList() << "j" << "threads", "Numero di thread.", "n", QString::number(QThread::idealThreadCount()));
+    QCommandLineOption chunk("chunk", "Righe per blocco di lavoro.", "righe", "65536");
+    QCommandLineOption distinct("distinct", "Conta una sola volta i dipinti ripetuti tra file diversi (la memoria cresce con i dipinti distinti).");
+    parser.addOptions({groupBy, format, output, titolo, scuola, secolo, sala, threads, chunk, distinct});
+    parser.process(a);
+
+    QTextStream err(stderr);
+    QStringList files = parser.positionalArguments();
+    QStringList gruppi = parser.values(groupBy);
+
+    if (gruppi.isEmpty())
+        gruppi << "scuola";
+
+    for (const QString &g : gruppi) {
+        if (!chiavi().contains(g)) {
+            err << "raggruppamento non valido: " << g << "\n";
+            return 1;
+        }
+    }
+
+    QString formato = parser.value(format);
+    if (formato != "csv" && formato != "json") {
+        err << "formato non valido: " << formato << "\n";
+        return 1;
+    }
+
+    if (files.isEmpty())
+        parser.showHelp(1);
+
+    filtri f;
+    f.titolo = parser.value(titolo);
+    f.scuola = parser.value(scuola);
+    f.secolo = parser.value(secolo);
+    f.sala = parser.value(sala);
+
+    int nThread = qMax(1, parser.value(threads).toInt());
+    int righePerBlocco = qMax(1, parser.value(chunk).toInt());
+    QThreadPool::globalInstance()->setMaxThreadCount(nThread);
+
+    conteggi totale;
+    visti_set visti;
+    visti_set *pVisti = parser.isSet(distinct) ? &visti : nullptr;
+
+    lettura input(files);
+    elabora_blocco elaboratore(f, gruppi, pVisti);
+    QFuture<conteggi> inCorso;
+    bool avviato = false;
+
+    // un gruppo di blocchi (uno per thread) viene letto mentre il precedente è in elaborazione
+    forever {
+        QVector<QStringList> blocchi = input.blocchi(nThread, righePerBlocco);
+
+        if (avviato) {
+            inCorso.waitForFinished();
+            for (const conteggi &p : inCorso.results())
+                unisci(totale, p);
+        }
+
+        if (!input.errorString().isEmpty()) {
+            err << input.errorString() << "\n";
+            return 1;
+        }
+
+        if (blocchi.isEmpty())
+            break;
+
+        inCorso = QtConcurrent::mapped(blocchi, elaboratore);
+        avviato = true;
+    }
+
+    QFile fileOut;
+    if (parser.isSet(output)) {
+        fileOut.setFileName(parser.value(output));
+        if (!fileOut.open(QIODevice::WriteOnly | QIODevice::Text)) {
+            err << fileOut.fileName() << ": " << fileOut.errorString() << "\n";
+            return 1;
+        }
+    } else
+        fileOut.open(stdout, QIODevice::WriteOnly);
+
+    QTextStream out(&fileOut);
+    if (formato == "json")
+        scriviJson(out, totale, gruppi);
+    else
+        scriviCsv(out, totale, gruppi);
+
+    return 0;
+}
@@ -0,0 +1,157 @@
+/**
+  @file concurrent_set.hpp
+
+  @brief File header della classe concurrent_set templata
+
+  Set per l'inserimento concorrente da più thread, da congelare
+  in un set ordinario al termine dell'inserimento.
+*/
+
+#ifndef CONCURRENT_SET_HPP
+#define CONCURRENT_SET_HPP
+
+#include <cstddef>       // per std::size_t
+#include <mutex>         // per std::mutex, std::lock_guard
+#include <unordered_set> // per std::unordered_set
+#include <vector>        // per std::vector
+#include "set.hpp"
+
+
+/**
+    @brief classe concurrent_set
+
+    Set di oggetti T con la stessa semantica di uguaglianza di set (funtore Equal),
+    diviso in partizioni ciascuna protetta dal proprio mutex.
+    Hash è un funtore che restituisce un hash a 64 bit coerente con Equal
+    (elementi uguali devono avere lo stesso hash): i bit alti scelgono la
+    partizione, quindi thread che inseriscono elementi diversi raramente
+    si contendono lo stesso lock.
+
+    add e contains possono essere chiamate da qualunque numero di thread;
+    freeze produce un set ordinario (contiguo, con handle) per la lettura.
+*/
+template <typename T, typename Equal, typename Hash>
+class concurrent_set {
+public:
+    typedef unsigned int size_type;
+
+private:
+    // adattatore per std::unordered_set, che richiede un hash di tipo std::size_t
+    struct hash_partizione {
+        Hash _hash;
+
+        std::size_t operator()(const T &value) const {
+            return static_cast<std::size_t>(_hash(value));
+        }
+    };
+
+    // std::vector con CONFIG += c++11 non rispetta alignas oltre alignof(std::max_align_t),
+    // quindi l'isolamento si ottiene con un'imbottitura di una linea di cache (64 byte)
+    // davanti ai campi: mutex ed elementi di partizioni vicine distano almeno 64 byte
+    // e non finiscono mai nella stessa linea, comunque sia allineato il vettore
+    struct partizione {
+        char imbottitura[64];
+        mutable std::mutex mutex;
+        std::unordered_set<T, hash_partizione, Equal> elementi;
+    };
+
+    std::vector<partizione> _partizioni;
+    unsigned int _bit;
+    Hash _hash;
+
+
+    partizione &scegli(const T &value) {
+        return _partizioni[static_cast<size_type>(_hash(value) >> (64 - _bit))];
+    }
+
+    const partizione &scegli(const T &value) const {
+        return _partizioni[static_cast<size_type>(_hash(value) >> (64 - _bit))];
+    }
+
+public:
+    /**
+        @brief Costruttore
+
+        @param bit le partizioni sono 2^bit (default 64 partizioni)
+    */
+    explicit concurrent_set(unsigned int bit = 6) : _partizioni(size_type(1) << bit), _bit(bit) {
+        assert(bit > 0 && bit < 32);
+    }
+
+    concurrent_set(const concurrent_set &other) = delete;
+    concurrent_set& operator=(const concurrent_set &other) = delete;
+
+
+    /**
+        @brief Funzione che aggiunge un elemento al set, sicura tra thread
+
+        @param value valore da aggiungere al set
+
+        @return true se l'elemento è stato aggiunto, false se era già presente
+    */
+    bool add(const T &value) {
+        partizione &p = scegli(value);
+        std::lock_guard<std::mutex> lock(p.mutex);
+
+        return p.elementi.insert(value).second;
+    }
+
+
+    /**
+        @brief Funzione che controlla se un elemento è presente, sicura tra thread
+
+        @param value valore da cercare nel set
+
+        @return true se il set contiene l'elemento value
+    */
+    bool contains(const T &value) const {
+        const partizione &p = scegli(value);
+        std::lock_guard<std::mutex> lock(p.mutex);
+
+        return p.elementi.count(value) > 0;
+    }
+
+
+    /**
+        @brief Funzione che restituisce il numero di elementi.
+        Con inserimenti in corso il valore è solo indicativo.
+
+        @return numero di elementi del set
+    */
+    size_type getNumElements() const {
+        size_type n = 0;
+
+        for (const partizione &p : _partizioni) {
+            std::lock_guard<std::mutex> lock(p.mutex);
+            n += static_cast<size_type>(p.elementi.size());
+        }
+
+        return n;
+    }
+
+
+    /**
+        @brief Funzione che copia gli elementi in un set ordinario
+
+        Gli elementi sono già distinti, quindi vengono aggiunti con
+        add_distinct in tempo lineare, dopo aver riservato lo spazio.
+        Va chiamata quando gli inserimenti sono terminati.
+
+        @param result set che riceve gli elementi (il contenuto precedente viene sostituito)
+    */
+    template <typename SetEqual>
+    void freeze(set<T, SetEqual> &result) const {
+        set<T, SetEqual> tmp;
+        tmp.reserve(getNumElements());
+
+        for (const partizione &p : _partizioni) {
+            std::lock_guard<std::mutex> lock(p.mutex);
+            for (const T &value : p.elementi)
+                tmp.add_distinct(value);
+        }
+
+        result.swap(tmp);
+    }
+};
+
+#endif
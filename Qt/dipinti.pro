@@ -0,0 +1,18 @@
+# Progetto completo: libreria del motore dei dati, interfaccia grafica e programma batch.
+# I benchmark richiedono Google Benchmark e si aggiungono con qmake CONFIG+=bench
+
+TEMPLATE = subdirs
+
+SUBDIRS = \
+    catalog \
+    app \
+    cli
+
+# app/app.pro è ProgQt.pro collegato alla libreria invece che ai sorgenti
+app.depends = catalog
+cli.depends = catalog
+
+bench {
+    SUBDIRS += bench
+    bench.depends = catalog
+}
@@ -0,0 +1,260 @@
+#include "dipinto.h"
+#include <cstring>
+#include <functional>
+#include <queue>
+
+namespace {
+
+const quint64 P1 = 11400714785074694791ULL;
+const quint64 P2 = 14029467366897019727ULL;
+const quint64 P3 = 1609587929392839161ULL;
+const quint64 P4 = 9650029242287828579ULL;
+const quint64 P5 = 2870177450012600261ULL;
+
+inline quint64 rotl(quint64 x, int r) {
+    return (x << r) | (x >> (64 - r));
+}
+
+inline quint64 leggi64(const uchar *p) {
+    quint64 v;
+    std::memcpy(&v, p, 8);
+    return v;
+}
+
+inline quint64 leggi32(const uchar *p) {
+    quint32 v;
+    std::memcpy(&v, p, 4);
+    return v;
+}
+
+inline quint64 xxh_round(quint64 acc, quint64 input) {
+    acc += input * P2;
+    acc = rotl(acc, 31);
+    return acc * P1;
+}
+
+inline quint64 merge(quint64 acc, quint64 val) {
+    acc ^= xxh_round(0, val);
+    return acc * P1 + P4;
+}
+
+// xxHash64 (https://github.com/Cyan4973/xxHash)
+quint64 xxh64(const uchar *p, size_t len, quint64 seed) {
+    const uchar *fine = p + len;
+    quint64 h;
+
+    if (len >= 32) {
+        quint64 v1 = seed + P1 + P2, v2 = seed + P2, v3 = seed, v4 = seed - P1;
+        const uchar *limite = fine - 32;
+        do {
+            v1 = xxh_round(v1, leggi64(p)); p += 8;
+            v2 = xxh_round(v2, leggi64(p)); p += 8;
+            v3 = xxh_round(v3, leggi64(p)); p += 8;
+            v4 = xxh_round(v4, leggi64(p)); p += 8;
+        } while (p <= limite);
+
+        h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+        h = merge(h, v1);
+        h = merge(h, v2);
+        h = merge(h, v3);
+        h = merge(h, v4);
+    } else
+        h = seed + P5;
+
+    h += len;
+
+    for (; p + 8 <= fine; p += 8)
+        h = rotl(h ^ xxh_round(0, leggi64(p)), 27) * P1 + P4;
+    if (p + 4 <= fine) {
+        h = rotl(h ^ (leggi32(p) * P1), 23) * P2 + P3;
+        p += 4;
+    }
+    for (; p < fine; ++p)
+        h = rotl(h ^ (*p * P5), 11) * P1;
+
+    h ^= h >> 33;
+    h *= P2;
+    h ^= h >> 29;
+    h *= P3;
+    h ^= h >> 32;
+
+    return h;
+}
+
+} // namespace
+
+
+QStringList parseLine(const QString &line) {
+    // split di virgole facendo escape tra quelle dentro le virgolette (titoli)
+    QStringList fields;
+    QString field;
+    bool insideQuotes = false;
+
+    for (const QChar &ch : line) {
+        if (ch == '\"')
+            insideQuotes = !insideQuotes;
+        else if (ch == ',' && !insideQuotes) {
+            fields.append(field.trimmed());
+            field.clear();
+        } else
+            field += ch;
+    }
+
+    fields.append(field.trimmed());
+
+    return fields;
+}
+
+
+QString setupStr(const QString &baseStr) {
+    int res;
+    bool preso = false;
+    QString result;
+    int count = 0;
+    // prende in input una data e ritorna una data "pulita" (primi n numeri < 4)
+
+    for (const QChar &ch : baseStr) {
+        if (ch.isDigit() && count <= 4) {
+            result.append(ch);
+            count++;
+            preso = true;
+        } else if(!ch.isDigit() && preso)
+            break;
+    }
+    res = result.toInt();
+
+    // rimuovo le ultime due cifre per categorizzare le date (1789 -> 17 secolo)
+    res/=100;
+
+    if (!preso)
+        return QString("NaN");
+
+
+    return QString::number(res).append("00");
+
+}
+
+
+int anno(const QString &data) {
+    QString cifre;
+
+    for (const QChar &ch : data) {
+        if (ch.isDigit()) {
+            if (cifre.size() < 4)
+                cifre.append(ch);
+        } else if (!cifre.isEmpty())
+            break;
+    }
+
+    return cifre.isEmpty() ? -1 : cifre.toInt();
+}
+
+
+QVector<QPair<QString, int>> topK(const QMap<QString, int> &conteggi, int k, const QString &altro) {
+    typedef QPair<int, QString> voce;
+    QVector<QPair<QString, int>> result;
+
+    // poche chiavi: nessuna voce altro, solo ordinamento
+    if (k <= 0 || conteggi.size() <= k) {
+        for (auto it = conteggi.begin(); it != conteggi.end(); ++it)
+            result.append(qMakePair(it.key(), it.value()));
+
+        std::stable_sort(result.begin(), result.end(),
+                         [](const QPair<QString, int> &a, const QPair<QString, int> &b) {
+            return a.second > b.second;
+        });
+
+        return result;
+    }
+
+    // min-heap delle k voci più grandi viste finora
+    std::priority_queue<voce, std::vector<voce>, std::greater<voce>> heap;
+    int resto = 0;
+
+    for (auto it = conteggi.begin(); it != conteggi.end(); ++it) {
+        heap.push(qMakePair(it.value(), it.key()));
+        if (int(heap.size()) > k) {
+            resto += heap.top().first;
+            heap.pop();
+        }
+    }
+
+    while (!heap.empty()) {
+        result.prepend(qMakePair(heap.top().second, heap.top().first));
+        heap.pop();
+    }
+
+    if (resto > 0)
+        result.append(qMakePair(altro, resto));
+
+    return result;
+}
+
+
+QVector<QPair<QString, int>> istogramma(const QMap<int, int> &anni, int maxBarre) {
+    QVector<QPair<QString, int>> result;
+
+    if (anni.isEmpty())
+        return result;
+
+    int primo = anni.firstKey();
+    int ultimo = anni.lastKey();
+    maxBarre = qMax(1, maxBarre);
+
+    // ampiezze 1, 5, 10, 25, 50, 100, 500, 1000, 2500, 5000, 10000...
+    static const int passi[] = { 1, 5, 10, 25, 50 };
+    int ampiezza = 1;
+    for (int scala = 1; ; scala *= 100) {
+        bool trovata = false;
+        for (int p : passi) {
+            ampiezza = p * scala;
+            if ((ultimo / ampiezza - primo / ampiezza + 1) <= maxBarre) {
+                trovata = true;
+                break;
+            }
+        }
+        if (trovata)
+            break;
+    }
+
+    int inizio = primo / ampiezza * ampiezza;
+    auto it = anni.begin();
+
+    for (int da = inizio; da <= ultimo; da += ampiezza) {
+        int conteggio = 0;
+        for (; it != anni.end() && it.key() < da + ampiezza; ++it)
+            conteggio += it.value();
+
+        QString etichetta = ampiezza == 1 ? QString::number(da)
+                                          : QString("%1-%2").arg(da).arg(da + ampiezza - 1);
+        result.append(qMakePair(etichetta, conteggio));
+    }
+
+    return result;
+}
+
+
+// ogni campo usa come seme l'hash dei precedenti; la lunghezza entra nell'hash
+// quindi ("ab", "c") e ("a", "bc") danno impronte diverse
+static quint64 improntaCampi(const QString *const campi[5]) {
+    quint64 h = 0;
+
+    for (int i = 0; i < 5; ++i)
+        h = xxh64(reinterpret_cast<const uchar *>(campi[i]->constData()), campi[i]->size() * sizeof(QChar), h);
+
+    return h;
+}
+
+
+quint64 dipinto::calcolaImpronta() const {
+    const QString *campi[] = { &_scuola, &_autore, &_titolo, &_data, &_sala };
+
+    return improntaCampi(campi);
+}
+
+
+quint64 dipinto::impronta(const QStringList &campi) {
+    const QString *c[] = { &campi[CAMPO_SCUOLA], &campi[CAMPO_AUTORE], &campi[CAMPO_TITOLO], &campi[CAMPO_DATA], &campi[CAMPO_SALA] };
+
+    return improntaCampi(c);
+}
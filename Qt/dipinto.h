@@ -0,0 +1,252 @@
+/**
+  @file dipinto.h
+
+  @brief File header della classe dipinto
+
+  Tipo dei dati della collezione e funzioni di lettura e aggregazione
+  che non dipendono dall'interfaccia grafica (solo QtCore).
+*/
+
+#ifndef DIPINTO_H
+#define DIPINTO_H
+
+#include <QString>
+#include <QStringList>
+#include <QMap>
+#include <QVector>
+#include "set.hpp"
+#include "ricerca.h"
+
+/**
+    @brief Funzione che divide una riga CSV nei suoi campi
+
+    Le virgole dentro le virgolette (es. "Empoli, L'") non separano i campi.
+
+    @param line riga da dividere
+
+    @return campi della riga, senza spazi iniziali e finali
+*/
+QStringList parseLine(const QString &line);
+
+/// posizione dei campi di un dipinto nelle righe del CSV (risultato di parseLine)
+enum campo_csv { CAMPO_SCUOLA, CAMPO_AUTORE, CAMPO_TITOLO, CAMPO_DATA, CAMPO_SALA, NUM_CAMPI };
+
+/**
+    @brief Funzione che riduce una data al secolo di appartenenza
+
+    Prende i primi numeri della data e toglie le ultime due cifre
+    (1789 circa -> 1700). Se la data non contiene numeri restituisce "NaN".
+
+    @param baseStr data da categorizzare
+
+    @return secolo della data
+*/
+QString setupStr(const QString &baseStr);
+
+/**
+    @brief Funzione che restituisce l'anno di una data (primi numeri, al massimo 4 cifre)
+
+    @param data data da leggere (es. "1600-1630 circa")
+
+    @return anno, -1 se la data non contiene numeri
+*/
+int anno(const QString &data);
+
+/**
+    @brief Funzione che restituisce le k chiavi con più elementi
+
+    Le chiavi vengono selezionate con un heap di k elementi (O(n log k));
+    le restanti vengono sommate in un'unica voce con etichetta altro.
+
+    @param conteggi mappa chiave -> numero di elementi
+    @param k numero massimo di chiavi, se <= 0 vengono restituite tutte
+    @param altro etichetta della voce che raccoglie le chiavi escluse
+
+    @return coppie (chiave, conteggio) in ordine di conteggio decrescente, seguite da altro se non vuoto
+*/
+QVector<QPair<QString, int>> topK(const QMap<QString, int> &conteggi, int k, const QString &altro = "Altro");
+
+/**
+    @brief Funzione che raggruppa gli anni in intervalli di uguale ampiezza
+
+    L'ampiezza viene scelta tra 1, 5, 10, 25, 50, 100, 500, 1000, 2500... anni,
+    la più piccola che produca al massimo maxBarre intervalli.
+
+    @param anni mappa anno -> numero di elementi
+    @param maxBarre numero massimo di intervalli
+
+    @return coppie (etichetta dell'intervallo, conteggio) in ordine di anno
+*/
+QVector<QPair<QString, int>> istogramma(const QMap<int, int> &anni, int maxBarre);
+
+
+class dipinto {
+  QString _scuola, _autore, _titolo, _data, _sala;
+  // titolo normalizzato, calcolato una volta alla costruzione
+  QString _chiave;
+  // hash a 64 bit dei cinque campi, calcolato una volta alla costruzione
+  quint64 _impronta;
+
+  quint64 calcolaImpronta() const;
+
+public:
+
+  dipinto() : _scuola(""), _autore(""), _titolo(""), _data(""), _sala(""), _chiave("") {
+      _impronta = calcolaImpronta();
+  }
+
+  dipinto(QString scuola, QString autore, QString titolo, QString data, QString sala) : _scuola(scuola), _autore(autore), _titolo(titolo), _data(data), _sala(sala), _chiave(normalizza(titolo)) {
+      _impronta = calcolaImpronta();
+  }
+
+  QString getScuola() const{
+      return _scuola;
+  }
+
+  QString getTitolo() const {
+      return _titolo;
+  }
+
+  QString getAutore()const {
+      return _autore;
+  }
+
+  QString getData() const {
+      return _data;
+  }
+
+  QString getSala() const {
+      return _sala;
+  }
+
+  QString getChiave() const {
+      return _chiave;
+  }
+
+  quint64 getImpronta() const {
+      return _impronta;
+  }
+
+  /**
+      @brief Funzione che calcola l'impronta dei campi di una riga senza costruire il dipinto
+      (niente normalizzazione del titolo)
+
+      @param campi scuola, autore, titolo, data e sala, come in parseLine
+
+      @return stessa impronta del dipinto costruito con quei campi
+  */
+  static quint64 impronta(const QStringList &campi);
+
+  // ricerca approssimata sul titolo normalizzato: sono ammessi errori fino a un quarto della query
+  struct ricerca_titolo {
+    QString title;
+    ricerca_approssimata query;
+    int tolleranza;
+
+    ricerca_titolo(const QString& titolo) : title(normalizza(titolo)), query(title), tolleranza(query.lunghezza() / 4) {}
+
+    // 0 se il titolo contiene la query, altrimenti il numero minimo di errori
+    int distanza(const dipinto &d1) const {
+        return query.distanza(d1._chiave);
+    }
+
+    bool operator()(const dipinto &d1) const {
+        return distanza(d1) <= tolleranza;
+    }
+  };
+
+
+  // chiavi di raggruppamento usate dai grafici
+  // le chiavi si applicano anche ai campi di una riga (campo_csv), senza costruire il dipinto
+  struct chiave_scuola {
+    QString operator()(const dipinto &d1) const {
+        return d1._scuola;
+    }
+    QString operator()(const QStringList &campi) const {
+        return campi[CAMPO_SCUOLA];
+    }
+  };
+
+  struct chiave_secolo {
+    QString operator()(const dipinto &d1) const {
+        return setupStr(d1._data.trimmed());
+    }
+    QString operator()(const QStringList &campi) const {
+        return setupStr(campi[CAMPO_DATA].trimmed());
+    }
+  };
+
+  struct chiave_sala {
+    QString operator()(const dipinto &d1) const {
+        return d1._sala;
+    }
+    QString operator()(const QStringList &campi) const {
+        return campi[CAMPO_SALA];
+    }
+  };
+
+  struct chiave_autore {
+    QString operator()(const dipinto &d1) const {
+        return d1._autore;
+    }
+    QString operator()(const QStringList &campi) const {
+        return campi[CAMPO_AUTORE];
+    }
+  };
+
+
+  // hash coerente con equal_dipinto, per concurrent_set
+  struct hash_dipinto {
+    quint64 operator()(const dipinto &d1) const {
+      return d1._impronta;
+    }
+  };
+
+
+  // impronte diverse escludono l'uguaglianza senza confrontare le stringhe
+  struct equal_dipinto {
+    bool operator()(const dipinto &d1, const dipinto &d2) const {
+      return d1._impronta == d2._impronta && d1._titolo == d2._titolo && d1._autore == d2._autore && d1._scuola == d2._scuola && d1._data == d2._data && d1._sala == d2._sala;
+    }
+  };
+};
+
+
+inline bool operator==(const dipinto &d1, const dipinto &d2) {
+    return dipinto::equal_dipinto()(d1, d2);
+}
+
+
+/**
+    @brief Funzione hash per QHash e QSet, riusa l'impronta del dipinto
+
+    @param d dipinto
+    @param seed seme dell'hash
+
+    @return hash del dipinto
+*/
+inline uint qHash(const dipinto &d, uint seed = 0) {
+    return uint(d.getImpronta() ^ (d.getImpronta() >> 32)) ^ seed;
+}
+
+
+/**
+    @brief Funzione che conta gli elementi selezionati per ciascuna chiave
+
+    @param st collezione dei dipinti (set, versioned_set o una sua versione)
+    @param sel handle degli elementi da contare (vettore di handle o selection)
+    @param chiave funtore che restituisce la chiave di raggruppamento
+
+    @return mappa chiave -> numero di elementi con quella chiave
+*/
+template <typename Collezione, typename Selezione, typename Chiave>
+QMap<QString, int> conteggio(const Collezione &st, const Selezione &sel, Chiave chiave) {
+    QMap<QString, int> valueCountMap;
+
+    for (auto h : sel)
+        ++valueCountMap[chiave(st.at(h))];
+
+    return valueCountMap;
+}
+
+#endif // DIPINTO_H
@@ -0,0 +1,100 @@
+/**
+  @file facet_index.hpp
+
+  @brief File header della classe facet_index templata
+
+  Indice per categoria (scuola, secolo, sala): una selection per ogni valore
+  della chiave, così i conteggi di una selezione non leggono i dipinti.
+*/
+
+#ifndef FACET_INDEX_HPP
+#define FACET_INDEX_HPP
+
+#include <QHash>
+#include <QMap>
+#include <QString>
+#include "selection.hpp"
+
+
+/**
+    @brief classe facet_index
+
+    Per ogni valore restituito da Chiave contiene la selection degli handle
+    degli elementi con quel valore. Va aggiornato insieme alla collezione
+    (insert dopo ogni aggiunta, erase prima di ogni rimozione).
+
+    Le selection sono compresse: una categoria con pochi elementi occupa
+    2 byte per elemento (array ordinato), una densa una bitmap per blocco
+    di 65536 handle. Le categorie rimaste vuote vengono tolte, quindi la
+    memoria è proporzionale al numero di elementi e le categorie visitate
+    dai conteggi sono solo quelle presenti nella collezione.
+
+    Il conteggio di una selezione costa, per ogni categoria, una
+    intersezione sui soli blocchi presenti in entrambe le selection.
+*/
+template <typename T, typename Chiave>
+class facet_index {
+public:
+    typedef selection::handle_type handle_type;
+
+private:
+    QHash<QString, selection> _faccette;
+    Chiave _chiave;
+
+public:
+    /**
+        @brief Funzione che registra un elemento nella selection della sua categoria
+
+        @param h handle dell'elemento
+        @param value elemento
+    */
+    void insert(handle_type h, const T &value) {
+        _faccette[_chiave(value)].insert(h);
+    }
+
+    /**
+        @brief Funzione che toglie un elemento dalla selection della sua categoria.
+        Una categoria rimasta vuota viene tolta dall'indice.
+
+        @param h handle dell'elemento
+        @param value elemento, ancora presente nella collezione
+    */
+    void erase(handle_type h, const T &value) {
+        typename QHash<QString, selection>::iterator i = _faccette.find(_chiave(value));
+
+        if (i == _faccette.end())
+            return;
+
+        i.value().erase(h);
+        if (i.value().empty())
+            _faccette.erase(i);
+    }
+
+    void clear() {
+        _faccette.clear();
+    }
+
+    /**
+        @brief Funzione che conta gli elementi selezionati per categoria
+
+        @param sel elementi da contare
+
+        @return mappa categoria -> numero di elementi, senza le categorie a zero
+    */
+    QMap<QString, int> counts(const selection &sel) const {
+        QMap<QString, int> risultato;
+
+        if (sel.empty())
+            return risultato;
+
+        for (typename QHash<QString, selection>::const_iterator i = _faccette.begin(); i != _faccette.end(); ++i) {
+            int n = sel.count_and(i.value());
+            if (n > 0)
+                risultato.insert(i.key(), n);
+        }
+
+        return risultato;
+    }
+};
+
+#endif
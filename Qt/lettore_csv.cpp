@@ -0,0 +1,74 @@
+#include "lettore_csv.h"
+
+
+bool lettore_csv::leggiRiga(QString &line) {
+    while (!_device.atEnd()) {
+        line = QString::fromUtf8(_device.readLine()).trimmed();
+        if (line.isEmpty())
+            continue;
+
+        // la prima riga è l'intestazione e non contiene un dipinto
+        if (_primaRiga) {
+            _intestazione = parseLine(line);
+            _primaRiga = false;
+            continue;
+        }
+
+        return true;
+    }
+
+    return false;
+}
+
+
+bool lettore_csv::prossimo(dipinto &d) {
+    QString line;
+
+    while (leggiRiga(line))
+        if (analizza(line, d))
+            return true;
+
+    return false;
+}
+
+
+bool lettore_csv::prossimiCampi(QStringList &campi) {
+    QString line;
+
+    while (leggiRiga(line))
+        if (dividi(line, campi))
+            return true;
+
+    return false;
+}
+
+
+QStringList lettore_csv::righe(int max) {
+    QStringList blocco;
+    QString line;
+
+    blocco.reserve(max);
+    while (blocco.size() < max && leggiRiga(line))
+        blocco.append(line);
+
+    return blocco;
+}
+
+
+bool lettore_csv::dividi(const QString &line, QStringList &campi) {
+    campi = parseLine(line);
+
+    return campi.size() >= NUM_CAMPI;
+}
+
+
+bool lettore_csv::analizza(const QString &line, dipinto &d) {
+    QStringList campi;
+
+    if (!dividi(line, campi))
+        return false;
+
+    d = dipinto(campi[CAMPO_SCUOLA], campi[CAMPO_AUTORE], campi[CAMPO_TITOLO], campi[CAMPO_DATA], campi[CAMPO_SALA]);
+
+    return true;
+}
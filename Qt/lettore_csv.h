@@ -0,0 +1,97 @@
+/**
+  @file lettore_csv.h
+
+  @brief File header della classe lettore_csv
+
+  Lettura in streaming dei CSV dei dipinti, condivisa da PaintingCatalog
+  (load, reload) e dal programma batch.
+*/
+
+#ifndef LETTORE_CSV_H
+#define LETTORE_CSV_H
+
+#include <QIODevice>
+#include <QStringList>
+#include "dipinto.h"
+
+/**
+    @brief classe lettore_csv
+
+    Legge un CSV riga per riga senza caricarlo in memoria. La prima riga
+    non vuota è l'intestazione; ogni riga successiva con almeno cinque campi
+    è un dipinto. Le righe possono essere lette già convertite in dipinti
+    (prossimo), come campi (prossimiCampi) o a blocchi di testo (righe),
+    da convertire con dividi o analizza anche in un altro thread.
+*/
+class lettore_csv {
+    QIODevice &_device;
+    QStringList _intestazione;
+    bool _primaRiga;
+
+    bool leggiRiga(QString &line);
+
+public:
+    explicit lettore_csv(QIODevice &device) : _device(device), _primaRiga(true) {}
+
+    /**
+        @brief Funzione che restituisce i nomi delle colonne
+
+        @return intestazione, vuota finché non è stata letta almeno una riga
+    */
+    QStringList intestazione() const {
+        return _intestazione;
+    }
+
+    bool atEnd() const {
+        return _device.atEnd();
+    }
+
+    /**
+        @brief Funzione che legge il prossimo dipinto, saltando le righe non valide
+
+        @param d dipinto letto
+
+        @return false a fine file
+    */
+    bool prossimo(dipinto &d);
+
+    /**
+        @brief Funzione che legge i campi della prossima riga valida senza costruire il dipinto
+
+        @param campi campi della riga, almeno cinque
+
+        @return false a fine file
+    */
+    bool prossimiCampi(QStringList &campi);
+
+    /**
+        @brief Funzione che legge un blocco di righe senza dividerle in campi
+
+        @param max numero massimo di righe
+
+        @return righe non vuote lette (l'intestazione esclusa)
+    */
+    QStringList righe(int max);
+
+    /**
+        @brief Funzione che divide una riga nei campi di un dipinto (campo_csv)
+
+        @param line riga del CSV
+        @param campi campi della riga
+
+        @return false se la riga ha meno di cinque campi
+    */
+    static bool dividi(const QString &line, QStringList &campi);
+
+    /**
+        @brief Funzione che converte una riga in un dipinto
+
+        @param line riga del CSV
+        @param d dipinto letto
+
+        @return false se la riga ha meno di cinque campi
+    */
+    static bool analizza(const QString &line, dipinto &d);
+};
+
+#endif // LETTORE_CSV_H
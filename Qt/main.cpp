@@ -1,10 +1,29 @@
 #include "mainwindow.h"
 
 #include <QApplication>
+#include <QCommandLineParser>
 
 int main(int argc, char *argv[]) {
     QApplication a(argc, argv);
-    MainWindow w;
+
+    // senza argomenti viene mostrato il dataset incluso nelle risorse;
+    // i file indicati invece vengono riletti ogni volta che cambiano
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Dipinti della Galleria degli Uffizi");
+    parser.addHelpOption();
+    parser.addPositionalArgument("csv", "File CSV da visualizzare e tenere aggiornati.", "[csv...]");
+
+    // categorie mostrate nei grafici prima di raggruppare le altre in "Altro"
+    QCommandLineOption fetteScuole("fette-scuole", "Fette del grafico delle scuole (default 10).", "n", "10");
+    QCommandLineOption fetteDate("fette-date", "Fette del grafico dei secoli (default 10).", "n", "10");
+    QCommandLineOption barreDate("barre-date", "Barre dell'istogramma delle date (default 30).", "n", "30");
+    parser.addOptions({fetteScuole, fetteDate, barreDate});
+    parser.process(a);
+
+    MainWindow w(parser.positionalArguments());
+    w.setChartLimits(qMax(1, parser.value(fetteScuole).toInt()),
+                     qMax(1, parser.value(fetteDate).toInt()),
+                     qMax(1, parser.value(barreDate).toInt()));
     w.show();
     return a.exec();
 }
@@ -1,19 +1,44 @@
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
-#include "QFile"
 #include "QDebug"
 #include <QtWidgets/QWidget>
+#include <QLabel>
+#include <QFileInfo>
 #include <QtCharts>
+#include <QtConcurrent>
 
 using namespace QtCharts;
 
-MainWindow::MainWindow(QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWindow) {
+MainWindow::MainWindow(const QStringList &sorgenti, QWidget *parent) : QMainWindow(parent), ui(new Ui::MainWindow), sorgenti(sorgenti) {
     ui->setupUi(this);
+
+    // al massimo un aggiornamento ogni 16 ms (circa un frame)
+    refreshTimer.setSingleShot(true);
+    refreshTimer.setInterval(16);
+    connect(&refreshTimer, &QTimer::timeout, this, &MainWindow::refresh);
+    connect(&aggregatiWatcher, &QFutureWatcher<aggregati>::finished, this, &MainWindow::applyAggregates);
+
+    // un editor salva spesso in piu' scritture: si controlla 300 ms dopo l'ultima notifica.
+    // Le cartelle sono osservate per accorgersi dei file cancellati e poi ricreati
+    reloadTimer.setSingleShot(true);
+    reloadTimer.setInterval(ATTESA_RELOAD);
+    connect(&reloadTimer, &QTimer::timeout, this, &MainWindow::reloadSources);
+    connect(&sorgentiWatcher, &QFileSystemWatcher::fileChanged, this, &MainWindow::sourceChanged);
+    connect(&sorgentiWatcher, &QFileSystemWatcher::directoryChanged, this, &MainWindow::sourceChanged);
+
+#ifdef DIPINTI_PROFILO
+    // tempi delle ultime operazioni e contatori nella barra di stato
+    profiloLabel = new QLabel(this);
+    ui->statusbar->addPermanentWidget(profiloLabel);
+#endif
+
     firstSetup();
+    updateStatus();
 }
 
 
 MainWindow::~MainWindow() {
+    aggregatiWatcher.waitForFinished();
     delete ui;
 }
 
@@ -22,63 +47,275 @@ void MainWindow::firstSetup(){
     // recupero dati e inizializzazione tabelle/grafici
     parseData();
     fillTable();
-    setupSchoolGraph();
-    setupDateGraph();
+    invalidate(GRAFICO_SCUOLE | GRAFICO_DATE);
 }
 
 
 void MainWindow::updateUI(){
-    setupSchoolGraph();
-    setupDateGraph();
+    invalidate(GRAFICO_SCUOLE | GRAFICO_DATE);
     clearTextEdits();
+    updateStatus();
+}
+
+
+void MainWindow::invalidate(int parti) {
+    sporco |= parti;
+
+    // le invalidazioni che arrivano prima dello scadere del timer vengono unite
+    if (!refreshTimer.isActive())
+        refreshTimer.start();
+}
+
+
+// conta gli anni delle date su uno snapshot del catalogo (eseguita in un thread di lavoro);
+// scuole e secoli non servono qui perche' vengono dagli indici del catalogo
+static aggregati calcolaAnni(PaintingCatalog::snapshot_type snap, const selection &sel) {
+    PROFILO_SCOPE("aggregati");
+    aggregati r;
+    r.parti = MainWindow::GRAFICO_DATE;
+    r.righe = sel.count();
+
+    for (auto h : sel) {
+        int a = anno(snap->at(h).getData());
+        if (a >= 0)
+            ++r.anni[a];
+        else
+            ++r.senzaAnno;
+    }
+
+    return r;
+}
+
+
+void MainWindow::refresh() {
+    if (sporco & TABELLA) {
+        sporco &= ~TABELLA;
+        updateTable(search);
+    }
+
+    // le torte di scuole e secoli si contano con gli indici del catalogo (intersezione con
+    // le righe visibili, blocco per blocco): costano poco anche con milioni di righe e non serve un thread
+    int faccette = sporco & GRAFICO_SCUOLE;
+    if (!ui->histogram_check->isChecked())
+        faccette |= sporco & GRAFICO_DATE;
+
+    if (faccette) {
+        PROFILO_SCOPE("faccette");
+        sporco &= ~faccette;
+
+        aggregati r;
+        r.parti = faccette;
+        r.righe = visibili.count();
+        if (faccette & GRAFICO_SCUOLE)
+            r.scuole = catalogo.perScuola(visibili);
+        if (faccette & GRAFICO_DATE)
+            r.secoli = catalogo.perSecolo(visibili);
+
+        showAggregates(r);
+    }
+
+    // resta solo l'istogramma, che deve leggere la data di ogni riga
+    if (!(sporco & GRAFICO_DATE))
+        return;
+
+    // un calcolo alla volta: la parte resta sporca e riparte alla fine del calcolo in corso
+    if (aggregatiWatcher.isRunning())
+        return;
+
+    sporco &= ~GRAFICO_DATE;
+
+    // lo snapshot resta invariato anche se il catalogo viene modificato durante il calcolo;
+    // al thread di lavoro passa la selection delle righe, non i dipinti
+    aggregatiWatcher.setFuture(QtConcurrent::run(calcolaAnni, catalogo.snapshot(), visibili));
+}
+
+
+void MainWindow::applyAggregates() {
+    aggregati r = aggregatiWatcher.result();
+
+    // se nel frattempo l'istogramma e' stato tolto il grafico e' gia' di nuovo sporco
+    if (ui->histogram_check->isChecked())
+        showAggregates(r);
+
+    if (sporco && !refreshTimer.isActive())
+        refreshTimer.start();
+}
+
+
+void MainWindow::showAggregates(const aggregati &r) {
+    // i risultati sostituiscono le serie dei grafici in un solo passo
+    if (r.parti & GRAFICO_SCUOLE)
+        setupSchoolGraph(r.scuole, r.righe);
+    if (r.parti & GRAFICO_DATE)
+        setupDateGraph(r);
+
+    updateStatus();
+}
+
+
+void MainWindow::updateStatus() {
+#ifdef DIPINTI_PROFILO
+    QStringList parti;
+
+    for (const profilo::statistica &s : profilo::statistiche())
+        parti << QString("%1 %2 ms").arg(QString::fromStdString(s.nome)).arg(s.ms_ultima, 0, 'f', 2);
+
+    parti << QString("sonde %1").arg(profilo::valore(profilo::SONDE))
+          << QString("confronti %1").arg(profilo::valore(profilo::CONFRONTI))
+          << QString("blocchi copiati %1").arg(profilo::valore(profilo::BLOCCHI_COPIATI))
+          << QString("riallocazioni %1").arg(profilo::valore(profilo::RIALLOCAZIONI))
+          << QString("byte copiati %1").arg(profilo::valore(profilo::BYTE_COPIATI))
+          << QString("righe %1").arg(profilo::valore(profilo::RIGHE));
+
+    profiloLabel->setText(parti.join(" | "));
+#endif
 }
 
 
 void MainWindow::parseData() {
+    if (sorgenti.isEmpty()) {
+        if (!catalogo.load(":/dataset/dipinti_uffizi.csv"))
+            qDebug() << catalogo.errorString();
+        return;
+    }
+
+    statoCaricato = statoControllato = statoSorgenti();
 
-    QFile file(":/dataset/dipinti_uffizi.csv");
+    for (const QString &path : sorgenti)
+        if (!catalogo.load(path))
+            qDebug() << path << catalogo.errorString();
 
-    if (!file.open(QIODevice::ReadOnly)) {
-        qDebug() << file.errorString();
+    osservaSorgenti();
+}
+
+
+void MainWindow::osservaSorgenti() {
+    for (const QString &path : sorgenti) {
+        QFileInfo info(path);
+
+        if (!sorgentiWatcher.directories().contains(info.absolutePath()))
+            sorgentiWatcher.addPath(info.absolutePath());
+
+        // un file cancellato o sostituito (salvataggio con rinomina) esce dal watcher:
+        // si rimette appena esiste di nuovo
+        if (info.exists() && !sorgentiWatcher.files().contains(path))
+            sorgentiWatcher.addPath(path);
     }
+}
 
-    dipinto tmp;
-    // lettura fino a fine file con split di virgole facendo escape tra quelle dentro le virgolette (titoli)
-    while (!file.atEnd()) {
-        QString line = file.readLine().trimmed();
-        if (!line.isEmpty()) {
-            QStringList fields;
-            QString field;
-            bool insideQuotes = false;
-
-            for (const QChar &ch : line) {
-                if (ch == '\"')
-                    insideQuotes = !insideQuotes;
-                else if (ch == ',' && !insideQuotes) {
-                    fields.append(field.trimmed());
-                    field.clear();
-                } else
-                    field += ch;
-            }
-
-            fields.append(field.trimmed());
-
-            for (int i = 0; i < qMin(5, fields.size()); ++i) {
-                tmp = dipinto(fields[0],fields[1],fields[2],fields[3],fields[4]);
-                s1.add(tmp);
-            }
 
-        }
+// per ogni file "dimensione data di modifica", vuoto se il file non esiste
+QStringList MainWindow::statoSorgenti() const {
+    QStringList stato;
+
+    for (const QString &path : sorgenti) {
+        QFileInfo info(path);
+        stato.append(info.exists() ? QString("%1 %2").arg(info.size()).arg(info.lastModified().toMSecsSinceEpoch()) : QString());
     }
+
+    return stato;
+}
+
+
+void MainWindow::sourceChanged(const QString &) {
+    osservaSorgenti();
+    tentativi = 0;
+    reloadTimer.start(ATTESA_RELOAD);
+}
+
+
+void MainWindow::riprovaReload(const QString &errore) {
+    // l'errore si scrive una volta sola per serie di tentativi
+    if (tentativi == 0)
+        qDebug() << errore;
+
+    // attesa doppia a ogni tentativo; esauriti i tentativi (file cancellato o senza permessi)
+    // si aspetta la prossima notifica del watcher, che osserva anche la cartella
+    if (++tentativi <= MAX_TENTATIVI)
+        reloadTimer.start(ATTESA_RELOAD << tentativi);
+}
+
+
+void MainWindow::reloadSources() {
+    osservaSorgenti();
+
+    // si rilegge solo quando tutti i file esistono e non sono cambiati dal controllo precedente,
+    // cioe' non sono piu' in scrittura; altrimenti si ricontrolla allo scadere del timer
+    QStringList stato = statoSorgenti();
+    bool stabile = stato == statoControllato;
+    statoControllato = stato;
+
+    int mancante = stato.indexOf(QString());
+    if (mancante >= 0) {
+        riprovaReload(sorgenti[mancante] + ": file assente");
+        return;
+    }
+
+    if (!stabile) {
+        reloadTimer.start(ATTESA_RELOAD);
+        return;
+    }
+
+    // notifica della cartella per un altro file: niente da rileggere
+    if (stato == statoCaricato)
+        return;
+
+    PaintingCatalog::modifiche delta;
+
+    if (!catalogo.reload(sorgenti, delta)) {
+        // file non leggibile o incompleto: il catalogo non cambia e si riprova
+        riprovaReload(catalogo.errorString());
+        return;
+    }
+
+    tentativi = 0;
+    statoCaricato = stato;
+    applyChanges(delta);
+}
+
+
+void MainWindow::applyChanges(const PaintingCatalog::modifiche &delta) {
+    if (delta.rimossi.isEmpty() && delta.aggiunti.isEmpty())
+        return;
+
+    // le righe dei dipinti rimossi si tolgono in un solo passaggio
+    if (!delta.rimossi.isEmpty()) {
+        selection rimossi;
+        for (auto h : delta.rimossi)
+            rimossi.insert(h);
+
+        modello->removeHandles(rimossi);
+        visibili -= rimossi;
+
+        selRow = -1;
+        ui->painting_table->clearSelection();
+        setRead(false);
+    }
+
+    // i nuovi dipinti che soddisfano la ricerca vanno in fondo, come quelli inseriti a mano
+    dipinto::ricerca_titolo filtro(ultimaRicerca);
+    selection aggiunti;
+    for (auto h : delta.aggiunti)
+        if (!search || filtro(catalogo.at(h)))
+            aggiunti.insert(h);
+
+    modello->appendRighe(catalogo.ordina(aggiunti, search ? ultimaRicerca : QString()));
+    visibili |= aggiunti;
+
+    // gli indici del catalogo sono gia' aggiornati, i grafici si ricontano da li'
+    invalidate(GRAFICO_SCUOLE | GRAFICO_DATE);
+    updateStatus();
 }
 
 
 void MainWindow::fillTable() {
-    set<dipinto, dipinto::equal_dipinto>::const_iterator i,ie;
+    PROFILO_SCOPE("fillTable");
     auto tbl = this->ui->painting_table;
 
-    tbl->setRowCount(0);
-    tbl->setColumnCount(5);
+    // la tabella mostra il modello, che legge i testi dal catalogo
+    modello = new PaintingModel(catalogo, this);
+    tbl->setModel(modello);
+    connect(tbl->selectionModel(), &QItemSelectionModel::selectionChanged, this, &MainWindow::tableSelectionChanged);
 
     // non cliccabile, selezione righe, resizabile
     tbl->setSelectionMode(QAbstractItemView::SingleSelection);
@@ -87,50 +324,25 @@ void MainWindow::fillTable() {
     tbl->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
     tbl->verticalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
 
+    updateTable(false);
+}
 
-    i = s1.begin();
-    ie = s1.end();
-    tbl->setHorizontalHeaderLabels(QStringList{i->getScuola(), i->getAutore(), i->getTitolo(), i->getData(), i->getSala()});
-
-    // rimuovo prima riga (intestazione)
-    s1.remove(dipinto(i->getScuola(), i->getAutore(), i->getTitolo(), i->getData(), i->getSala()));
-    i++;
 
-    for(; i != ie; ++i) {
-        tbl->insertRow(tbl->rowCount());
-        tbl->setItem(tbl->rowCount()-1, 0, new QTableWidgetItem(i->getScuola()));
-        tbl->setItem(tbl->rowCount()-1, 1, new QTableWidgetItem(i->getAutore()));
-        tbl->setItem(tbl->rowCount()-1, 2, new QTableWidgetItem(i->getTitolo()));
-        tbl->setItem(tbl->rowCount()-1, 3, new QTableWidgetItem(i->getData()));
-        tbl->setItem(tbl->rowCount()-1, 4, new QTableWidgetItem(i->getSala()));
-    }
+void MainWindow::appendRow(PaintingCatalog::handle_type h) {
+    // la riga appena inserita punta all'elemento tramite il suo handle
+    modello->appendRighe(PaintingCatalog::selezione() << h);
+    visibili.insert(h);
 }
 
 
 void MainWindow::updateTable(bool search) {
-    set<dipinto, dipinto::equal_dipinto>::const_iterator i,ie;
-    auto tbl = this->ui->painting_table;
-    tbl->clearContents();
-    tbl->model()->removeRows(0, tbl->rowCount());
-
-
-    // caricamento dati normale
-    if(!search) {
-        i = s1.begin();
-        ie = s1.end();
-    } else { // cericamento dati ricerca
-        i = tmp.begin();
-        ie = tmp.end();
-    }
+    PROFILO_SCOPE("updateTable");
+    selRow = -1;
 
-    for(; i != ie; ++i) {
-        tbl->insertRow(tbl->rowCount());
-        tbl->setItem(tbl->rowCount()-1, 0, new QTableWidgetItem(i->getScuola()));
-        tbl->setItem(tbl->rowCount()-1, 1, new QTableWidgetItem(i->getAutore()));
-        tbl->setItem(tbl->rowCount()-1, 2, new QTableWidgetItem(i->getTitolo()));
-        tbl->setItem(tbl->rowCount()-1, 3, new QTableWidgetItem(i->getData()));
-        tbl->setItem(tbl->rowCount()-1, 4, new QTableWidgetItem(i->getSala()));
-    }
+    // tutti i dipinti o, in modalita ricerca, quelli trovati; l'ordine per pertinenza
+    // serve solo alle righe della tabella, i grafici usano la selection
+    visibili = search ? catalogo.filtra(ultimaRicerca) : catalogo.validi();
+    modello->setRighe(catalogo.ordina(visibili, search ? ultimaRicerca : QString()));
 }
 
 
@@ -144,54 +356,29 @@ void MainWindow::clearTextEdits() {
 }
 
 
-QString MainWindow::setupStr(QString baseStr) {
-    int res;
-    bool preso = false;
-    QString result;
-    int count = 0;
-    // prende in input una data e ritorna una data "pulita" (primi n numeri < 4)
-
-    for (const QChar &ch : baseStr) {
-        if (ch.isDigit() && count <= 4) {
-            result.append(ch);
-            count++;
-            preso = true;
-        } else if(!ch.isDigit() && preso)
-            break;
-    }
-    res = result.toInt();
-
-    // rimuovo le ultime due cifre per categorizzare le date (1789 -> 17 secolo)
-    res/=100;
-
-    if (!preso)
-        return QString("NaN");
+void MainWindow::setChartLimits(int fetteScuole, int fetteDate, int barreDate) {
+    maxFetteScuole = fetteScuole;
+    maxFetteDate = fetteDate;
+    maxBarreDate = barreDate;
+    invalidate(GRAFICO_SCUOLE | GRAFICO_DATE);
+}
 
 
-    return QString::number(res).append("00");
+// rimuove serie e assi precedenti dal grafico
+static void clearChart(QChart *chart) {
+    chart->removeAllSeries();
 
+    for (QAbstractAxis *asse : chart->axes()) {
+        chart->removeAxis(asse);
+        delete asse;
+    }
 }
 
 
-void MainWindow::setupSchoolGraph() {
-    auto tbl = this->ui->painting_table;
-    int rowCount = tbl->rowCount();
-    // mappa chiave valore (scuola -> numero elem con stessa scuola)
-    QMap<QString, int> valueCountMap;
-
-    for (int row = 0; row < rowCount; ++row) {
-        // prendo solo la colonna della scuola
-        QTableWidgetItem *item = tbl->item(row, 0);
-        if (item) {
-            QString cellValue = item->text();
-            // se esiste nella mappa aumento il contatore dell'elemento, senno aggiungo nuovo
-            if (valueCountMap.contains(cellValue)) {
-                valueCountMap[cellValue]++;
-            } else {
-                valueCountMap.insert(cellValue, 1);
-            }
-        }
-    }
+void MainWindow::setupSchoolGraph(const QMap<QString, int> &valueCountMap, int rowCount) {
+    PROFILO_SCOPE("setupSchoolGraph");
+    // valueCountMap: scuola -> numero elem con stessa scuola sulle righe visualizzate
+    // solo le maxFetteScuole scuole piu' numerose hanno una fetta propria
 
     // Creazione dei dati per il grafico a torta
     QtCharts::QPieSeries *series = new QtCharts::QPieSeries();
@@ -201,60 +388,74 @@ void MainWindow::setupSchoolGraph() {
 
 
     // Percentuali
-    for (auto it = valueCountMap.begin(); it != valueCountMap.end(); ++it) {
-        QtCharts::QPieSlice *slice = series->append(it.key(), it.value());
-        slice->setLabel(it.key() + ": " + QString::number(it.value()/double(rowCount)*100,'f',2) + "%");
+    for (const auto &fetta : topK(valueCountMap, maxFetteScuole)) {
+        QtCharts::QPieSlice *slice = series->append(fetta.first, fetta.second);
+        slice->setLabel(fetta.first + ": " + QString::number(fetta.second/double(rowCount)*100,'f',2) + "%");
 
     }
 
     // rimuove le serie precedenti e crea una nuova che conterrà la mia torta
-    this->ui->schoolGraph->chart()->removeAllSeries();
+    clearChart(this->ui->schoolGraph->chart());
     this->ui->schoolGraph->chart()->addSeries(series);
 
 }
 
 
-void MainWindow::setupDateGraph() {
+void MainWindow::setupDateGraph(const aggregati &r) {
+    PROFILO_SCOPE("setupDateGraph");
+    QChart *chart = this->ui->datesGraph->chart();
 
+    chart->setTitle("Date");
+    chart->legend()->setAlignment(Qt::AlignRight);
+    clearChart(chart);
 
-    auto tbl = this->ui->painting_table;
-    int rowCount = tbl->rowCount();
-    // mappa chiave valore (data -> numero elem con stessa scuola)
-    QMap<QString, int> valueCountMap;
-
-    for (int row = 0; row < rowCount; ++row) {
-        // prendo solo la colonna delle date
-        QTableWidgetItem *item = tbl->item(row, 3);
-        if (item) {
-            QString cellValue = item->text().trimmed();
-            cellValue = setupStr(cellValue);
-
-            // se esiste nella mappa aumento il contatore dell'elemento, senno aggiungo nuovo
-            if (valueCountMap.contains(cellValue)) {
-                valueCountMap[cellValue]++;
-            } else {
-                valueCountMap.insert(cellValue, 1);
-            }
+    if (ui->histogram_check->isChecked()) {
+        // istogramma: al massimo maxBarreDate intervalli di anni, piu' una barra per le date senza anno
+        QVector<QPair<QString, int>> barre = istogramma(r.anni, maxBarreDate);
+        if (r.senzaAnno > 0)
+            barre.append(qMakePair(QString("NaN"), r.senzaAnno));
+
+        QBarSet *valori = new QBarSet("Dipinti");
+        QStringList categorie;
+        int massimo = 0;
+        for (const auto &barra : barre) {
+            *valori << barra.second;
+            categorie << barra.first;
+            massimo = qMax(massimo, barra.second);
         }
+
+        QBarSeries *series = new QBarSeries();
+        series->append(valori);
+        chart->addSeries(series);
+        chart->legend()->setVisible(false);
+
+        QBarCategoryAxis *asseX = new QBarCategoryAxis();
+        asseX->append(categorie);
+        asseX->setLabelsAngle(-90);
+        chart->addAxis(asseX, Qt::AlignBottom);
+        series->attachAxis(asseX);
+
+        QValueAxis *asseY = new QValueAxis();
+        asseY->setRange(0, massimo);
+        asseY->setLabelFormat("%d");
+        chart->addAxis(asseY, Qt::AlignLeft);
+        series->attachAxis(asseY);
+        return;
     }
 
-    // Creazione dei dati per il grafico a torta
+    // Creazione dei dati per il grafico a torta (secolo -> numero elem con stesso secolo)
     QtCharts::QPieSeries *series = new QtCharts::QPieSeries();
     series->setPieSize(1.0f);
 
 
-    for (auto it = valueCountMap.begin(); it != valueCountMap.end(); ++it) {
-        QtCharts::QPieSlice *slice = series->append(it.key(), it.value());
-        slice->setLabel(it.key() + ": " + QString::number(it.value()));
+    for (const auto &fetta : topK(r.secoli, maxFetteDate)) {
+        QtCharts::QPieSlice *slice = series->append(fetta.first, fetta.second);
+        slice->setLabel(fetta.first + ": " + QString::number(fetta.second));
 
     }
 
-    this->ui->datesGraph->chart()->setTitle("Date");
-    this->ui->datesGraph->chart()->legend()->setAlignment(Qt::AlignRight);
-
-    // rimuove le serie precedenti e crea una nuova che conterrà la mia torta
-    this->ui->datesGraph->chart()->removeAllSeries();
-    this->ui->datesGraph->chart()->addSeries(series);
+    chart->legend()->setVisible(true);
+    chart->addSeries(series);
 }
 
 
@@ -285,21 +486,17 @@ void MainWindow::on_add_button_clicked() {
     }
 
     dipinto p1;
-    int row = ui->painting_table->rowCount();
 
     p1 = dipinto(scuola, autore, titolo, data, sala);
 
     // se ho aggiunto allora aggiorno la tabella che si sta visualizzando
     // se sono in modalita ricerca controllo che il nuovo inserito soddisfi o meno il filtro
-    if (s1.add(p1)) {
-        if (!search || dipinto::ricerca_titolo(ultimaRicerca)(p1)) {
-            ui->painting_table->insertRow(row);
-            ui->painting_table->setItem(row, 0, new QTableWidgetItem(ui->school_edit->text().trimmed()));
-            ui->painting_table->setItem(row, 1, new QTableWidgetItem(ui->author_edit->text().trimmed()));
-            ui->painting_table->setItem(row, 2, new QTableWidgetItem(ui->title_edit->text().trimmed()));
-            ui->painting_table->setItem(row, 3, new QTableWidgetItem(ui->date_edit->text().trimmed()));
-            ui->painting_table->setItem(row, 4, new QTableWidgetItem(ui->room_edit->text().trimmed()));
-        }
+    PaintingCatalog::handle_type h = catalogo.add(p1);
+
+    if (h != PaintingCatalog::npos) {
+        if (!search || dipinto::ricerca_titolo(ultimaRicerca)(p1))
+            appendRow(h);
+
         updateUI();
     } else {
         msgBox.setWindowTitle("Il dipinto inserito esiste già");
@@ -326,16 +523,31 @@ void MainWindow::on_remove_button_clicked() {
         return;
     }
 
-    dipinto p1;
-    p1 = dipinto(scuola, autore, titolo, data, sala);
+    // se c'e' una riga selezionata l'handle e' gia' noto, altrimenti lo cerco dai campi
+    PaintingCatalog::handle_type h;
+    int row = selRow;
+
+    if (row >= 0 && row < modello->rowCount())
+        h = modello->handleAt(row);
+    else {
+        h = catalogo.find(dipinto(scuola, autore, titolo, data, sala));
+        row = modello->rowOf(h);
+    }
+
+    if (catalogo.remove(h)) {
+        // l'handle puo' essere riusato da un inserimento successivo
+        visibili.erase(h);
 
-    if (s1.remove(p1)) {
-        if (ui->painting_table->rowCount()==1) {
+        if (modello->rowCount()==1) {
             ui->search_edit->setText("");
             search = false;
             updateTable(search);
-        } else
-            ui->painting_table->removeRow(selRow);
+        } else if (row >= 0) {
+            selRow = -1;
+            modello->removeRow(row);
+        }
+
+        selRow = -1;
 
         ui->painting_table->clearSelection();
         updateUI();
@@ -353,32 +565,39 @@ void MainWindow::on_search_button_clicked() {
     QString title = ui->search_edit->text().trimmed();
     if (title != "") {
         search = true;
-        tmp = filter_out(s1,dipinto::ricerca_titolo(title));
         ultimaRicerca = title;
 
-        updateTable(search);
+        invalidate(TABELLA);
         setRead(false);
     } else {
         QMessageBox msgBox;
         msgBox.setWindowTitle("Campo ricerca vuoto");
         msgBox.setText("Inserire dati nel campo ricerca.");
         msgBox.exec();
-        updateTable(false);
+        search = false;
+        invalidate(TABELLA);
     }
     updateUI();
 
 }
 
 
-void MainWindow::on_painting_table_itemSelectionChanged() {
-    // Prendo riga selezionata e prendo le colonne
-    auto tbl = ui->painting_table;
-    int selectedRow = tbl->currentRow();
-    ui->school_edit->setText(tbl->item(selectedRow, 0)->text());
-    ui->author_edit->setText(tbl->item(selectedRow, 1)->text());
-    ui->title_edit->setText(tbl->item(selectedRow, 2)->text());
-    ui->date_edit->setText(tbl->item(selectedRow, 3)->text());
-    ui->room_edit->setText(tbl->item(selectedRow, 4)->text());
+void MainWindow::tableSelectionChanged() {
+    // Prendo riga selezionata e leggo il dipinto dal set tramite il suo handle
+    QModelIndexList selezionate = ui->painting_table->selectionModel()->selectedRows();
+
+    if (selezionate.isEmpty() || selezionate.first().row() >= modello->rowCount()) {
+        selRow = -1;
+        return;
+    }
+
+    int selectedRow = selezionate.first().row();
+    const dipinto &d = catalogo.at(modello->handleAt(selectedRow));
+    ui->school_edit->setText(d.getScuola());
+    ui->author_edit->setText(d.getAutore());
+    ui->title_edit->setText(d.getTitolo());
+    ui->date_edit->setText(d.getData());
+    ui->room_edit->setText(d.getSala());
 
     setRead(true);
     selRow = selectedRow;
@@ -387,12 +606,15 @@ void MainWindow::on_painting_table_itemSelectionChanged() {
 
 void MainWindow::on_clear_button_clicked() {
     ui->painting_table->clearSelection();
-    ui->painting_table->clearContents();
-    ui->painting_table->model()->removeRows(0, ui->painting_table->rowCount());
     search = false;
-    updateTable(false);
+    invalidate(TABELLA);
     setRead(false);
     ui->search_edit->setText("");
     updateUI();
 }
 
+
+void MainWindow::on_histogram_check_toggled(bool checked) {
+    Q_UNUSED(checked);
+    invalidate(GRAFICO_DATE);
+}
@@ -2,91 +2,105 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
-#include "set.hpp"
+#include <QVector>
+#include <QTimer>
+#include <QFutureWatcher>
+#include <QFileSystemWatcher>
+#include "paintingcatalog.h"
+#include "paintingmodel.h"
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
+class QLabel;
 QT_END_NAMESPACE
 
-class dipinto {
-  QString _scuola, _autore, _titolo, _data, _sala;
-
-public:
-
-  dipinto() : _scuola(""), _autore(""), _titolo(""), _data(""), _sala("") {}
-
-  dipinto(QString scuola, QString autore, QString titolo, QString data, QString sala) : _scuola(scuola), _autore(autore), _titolo(titolo), _data(data), _sala(sala) {}
-
-  QString getScuola() const{
-      return _scuola;
-  }
-
-  QString getTitolo() const {
-      return _titolo;
-  }
-
-  QString getAutore()const {
-      return _autore;
-  }
-
-  QString getData() const {
-      return _data;
-  }
-
-  QString getSala() const {
-      return _sala;
-  }
-
-  struct ricerca_titolo {
-    QString title;
-
-    ricerca_titolo(const QString& titolo) : title(titolo) {}
-
-    bool operator()(dipinto d1) const {
-        return d1._titolo.toLower().contains(title.toLower());
-    }
-  };
-
-
-  struct equal_dipinto {
-    bool operator()(dipinto d1, dipinto d2) const {
-      return d1._titolo == d2._titolo && d1._autore == d2._autore && d1._scuola == d2._scuola && d1._data == d2._data && d1._sala == d2._sala;
-    }
-  };
+// conteggi dei grafici: scuole e secoli dagli indici del catalogo,
+// anni calcolati fuori dal thread dell'interfaccia
+struct aggregati {
+    int parti = 0;
+    int righe = 0;
+    QMap<QString, int> scuole;
+    QMap<QString, int> secoli;
+    // anno -> numero di dipinti, e dipinti senza anno, per l'istogramma delle date
+    QMap<int, int> anni;
+    int senzaAnno = 0;
 };
 
-
 class MainWindow : public QMainWindow
 {
     Q_OBJECT
 
 public:
-    MainWindow(QWidget *parent = nullptr);
+    // parti della finestra da ridisegnare
+    enum { TABELLA = 1, GRAFICO_SCUOLE = 2, GRAFICO_DATE = 4 };
+
+    MainWindow(const QStringList &sorgenti = QStringList(), QWidget *parent = nullptr);
     void firstSetup();
     void parseData();
     void fillTable();
-    void setupSchoolGraph();
+    void setupSchoolGraph(const QMap<QString, int> &valueCountMap, int rowCount);
     void updateUI();
-    void setupDateGraph();
+    void setupDateGraph(const aggregati &r);
+    void setChartLimits(int fetteScuole, int fetteDate, int barreDate);
     void clearTextEdits();
-    QString setupStr(QString baseStr);
+    void invalidate(int parti);
 
     void updateTable(bool search);
+    void appendRow(PaintingCatalog::handle_type h);
     void setRead(bool readOnly);
+    void updateStatus();
+    void showAggregates(const aggregati &r);
+    void applyChanges(const PaintingCatalog::modifiche &delta);
     ~MainWindow();
 
 private slots:
     void on_add_button_clicked();
     void on_remove_button_clicked();
     void on_search_button_clicked();
-    void on_painting_table_itemSelectionChanged();
+    void tableSelectionChanged();
     void on_clear_button_clicked();
+    void refresh();
+    void applyAggregates();
+    void on_histogram_check_toggled(bool checked);
+    void sourceChanged(const QString &path);
+    void reloadSources();
 
 private:
     Ui::MainWindow *ui;
-    set<dipinto, dipinto::equal_dipinto> s1;
-    set<dipinto, dipinto::equal_dipinto> tmp;
+    QLabel *profiloLabel = nullptr;
+    PaintingCatalog catalogo;
+    // righe della tabella (handle del catalogo, in ordine di riga)
+    PaintingModel *modello = nullptr;
+    // gli stessi handle come selection, usata dai conteggi dei grafici
+    selection visibili;
     bool search = false;
     QString ultimaRicerca = "";
-    int selRow = 0;
+    int selRow = -1;
+
+    // fette mostrate nei grafici a torta (le altre finiscono in "Altro") e barre dell'istogramma
+    int maxFetteScuole = 10;
+    int maxFetteDate = 10;
+    int maxBarreDate = 30;
+
+    // parti da ridisegnare, raccolte dal timer in un solo aggiornamento per intervallo
+    int sporco = 0;
+    QTimer refreshTimer;
+    QFutureWatcher<aggregati> aggregatiWatcher;
+
+    // file CSV da cui e' stato caricato il catalogo (vuoto: dataset incluso nelle risorse),
+    // riletti quando cambiano; le notifiche ravvicinate producono una sola rilettura
+    QStringList sorgenti;
+    QFileSystemWatcher sorgentiWatcher;
+    QTimer reloadTimer;
+    // dimensione e data di modifica dei file al controllo precedente e all'ultima lettura
+    QStringList statoControllato;
+    QStringList statoCaricato;
+    // riletture fallite di seguito; l'attesa raddoppia a ogni tentativo
+    static const int ATTESA_RELOAD = 300;
+    static const int MAX_TENTATIVI = 5;
+    int tentativi = 0;
+
+    void osservaSorgenti();
+    QStringList statoSorgenti() const;
+    void riprovaReload(const QString &errore);
 };
 #endif // MAINWINDOW_H
@@ -0,0 +1,231 @@
+#include "paintingcatalog.h"
+#include "lettore_csv.h"
+#include <QFile>
+#include <QSet>
+#include <algorithm>
+
+const PaintingCatalog::handle_type PaintingCatalog::npos;
+
+
+bool PaintingCatalog::load(const QString &path) {
+    QFile file(path);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        _errore = file.errorString();
+        return false;
+    }
+
+    return load(file);
+}
+
+
+bool PaintingCatalog::load(QIODevice &device) {
+    PROFILO_SCOPE("parseData");
+    _errore.clear();
+
+    lettore_csv lettore(device);
+    dipinto d;
+
+    while (lettore.prossimo(d)) {
+        handle_type h = inserisci(d);
+        if (h != npos)
+            _caricati.insert(d.getImpronta(), h);
+    }
+
+    _intestazione = lettore.intestazione();
+
+    // una sola versione pubblicata per l'intero caricamento
+    _dipinti.publish();
+
+    return true;
+}
+
+
+bool PaintingCatalog::reload(const QStringList &paths, modifiche &delta) {
+    PROFILO_SCOPE("reload");
+    // impronte di tutte le righe lette; i campi solo per le righe che non c'erano alla lettura precedente
+    QSet<quint64> lette;
+    QHash<quint64, QStringList> nuove;
+
+    // prima si leggono tutti i file: se uno non si apre il catalogo non cambia
+    for (const QString &path : paths) {
+        QFile file(path);
+
+        if (!file.open(QIODevice::ReadOnly)) {
+            _errore = path + ": " + file.errorString();
+            return false;
+        }
+
+        // le righe si confrontano per impronta dei campi: il dipinto (normalizzazione del titolo,
+        // indici) si costruisce solo per le righe aggiunte
+        lettore_csv lettore(file);
+        QStringList campi;
+        while (lettore.prossimiCampi(campi)) {
+            quint64 impronta = dipinto::impronta(campi);
+            lette.insert(impronta);
+            if (!_caricati.contains(impronta))
+                nuove.insert(impronta, campi);
+        }
+
+        // un file troncato durante il salvataggio non ha ancora l'intestazione:
+        // leggerlo toglierebbe dal catalogo tutti i suoi dipinti
+        if (lettore.intestazione().isEmpty()) {
+            _errore = path + ": file vuoto o incompleto";
+            return false;
+        }
+    }
+
+    _errore.clear();
+    delta.rimossi.clear();
+    delta.aggiunti.clear();
+
+    // confronto per impronta con le righe lette l'ultima volta: costa una ricerca per riga
+    // e le modifiche toccano solo le righe cambiate
+    for (QHash<quint64, handle_type>::iterator i = _caricati.begin(); i != _caricati.end(); ) {
+        if (lette.contains(i.key()))
+            ++i;
+        else {
+            handle_type h = i.value();
+            i = _caricati.erase(i);
+            togli(h);
+            delta.rimossi.append(h);
+        }
+    }
+
+    // le rimozioni vengono prima, così gli aggiunti possono riusare gli handle liberati;
+    // un dipinto inserito a mano prima che comparisse nel file resta e da ora segue il file
+    for (QHash<quint64, QStringList>::const_iterator i = nuove.constBegin(); i != nuove.constEnd(); ++i) {
+        const QStringList &c = i.value();
+        dipinto d(c[CAMPO_SCUOLA], c[CAMPO_AUTORE], c[CAMPO_TITOLO], c[CAMPO_DATA], c[CAMPO_SALA]);
+
+        handle_type h = inserisci(d);
+        if (h != npos)
+            delta.aggiunti.append(h);
+        else
+            h = find(d);
+
+        _caricati.insert(i.key(), h);
+    }
+
+    _dipinti.publish();
+
+    return true;
+}
+
+
+selection PaintingCatalog::filtra(const QString &titolo) const {
+    PROFILO_SCOPE("filtra");
+    dipinto::ricerca_titolo filtro(titolo);
+    QVector<handle_type> candidati;
+
+    // l'indice dei trigrammi scarta i titoli troppo diversi; le query corte controllano tutto il catalogo
+    if (!_titoli.candidati(filtro.title, filtro.tolleranza, _dipinti.handle_bound(), candidati))
+        return seleziona(_dipinti, filtro);
+
+    selection sel;
+    for (handle_type h : candidati)
+        if (filtro(_dipinti.at(h)))
+            sel.insert(h);
+
+    return sel;
+}
+
+
+PaintingCatalog::selezione PaintingCatalog::ordina(const selection &sel, const QString &titolo) const {
+    selezione righe;
+    righe.reserve(sel.count());
+
+    if (titolo.isEmpty()) {
+        for (handle_type h : sel)
+            righe.append(h);
+
+        return righe;
+    }
+
+    dipinto::ricerca_titolo filtro(titolo);
+    QVector<QPair<int, handle_type>> risultati;
+    risultati.reserve(righe.capacity());
+
+    for (handle_type h : sel)
+        risultati.append(qMakePair(filtro.distanza(_dipinti.at(h)), h));
+
+    // risultati ordinati per numero di errori crescente
+    std::stable_sort(risultati.begin(), risultati.end(),
+                     [](const QPair<int, handle_type> &a, const QPair<int, handle_type> &b) {
+        return a.first < b.first;
+    });
+
+    for (const auto &r : risultati)
+        righe.append(r.second);
+
+    return righe;
+}
+
+
+PaintingCatalog::handle_type PaintingCatalog::add(const dipinto &d) {
+    handle_type h = inserisci(d);
+
+    if (h != npos)
+        _dipinti.publish();
+
+    return h;
+}
+
+
+bool PaintingCatalog::remove(handle_type h) {
+    if (!_dipinti.valid(h))
+        return false;
+
+    _caricati.remove(_dipinti.at(h).getImpronta());
+    togli(h);
+    _dipinti.publish();
+
+    return true;
+}
+
+
+PaintingCatalog::handle_type PaintingCatalog::inserisci(const dipinto &d) {
+    // la presenza si controlla con l'indice hash invece che con la scansione di versioned_set::add
+    if (find(d) != npos)
+        return npos;
+
+    handle_type h = _dipinti.add_distinct(d, false);
+    indicizza(h);
+
+    return h;
+}
+
+
+void PaintingCatalog::togli(handle_type h) {
+    // gli indici vanno aggiornati finché il dipinto è ancora nel catalogo
+    const dipinto &d = _dipinti.at(h);
+    _indice.remove(d);
+    _scuole.erase(h, d);
+    _secoli.erase(h, d);
+    _sale.erase(h, d);
+    _titoli.erase(h, d.getChiave());
+
+    _dipinti.remove_handle(h, false);
+}
+
+
+void PaintingCatalog::indicizza(handle_type h) {
+    const dipinto &d = _dipinti.at(h);
+    _indice.insert(d, h);
+    _scuole.insert(h, d);
+    _secoli.insert(h, d);
+    _sale.insert(h, d);
+    _titoli.insert(h, d.getChiave());
+}
+
+
+void PaintingCatalog::clear() {
+    _dipinti.empty();
+    _indice.clear();
+    _caricati.clear();
+    _scuole.clear();
+    _secoli.clear();
+    _sale.clear();
+    _titoli.clear();
+    _intestazione.clear();
+}
@@ -0,0 +1,199 @@
+/**
+  @file paintingcatalog.h
+
+  @brief File header della classe PaintingCatalog
+
+  Motore dei dati della collezione: lettura, ricerca, aggregazione e
+  modifica dei dipinti. Dipende solo da QtCore, quindi può essere usato
+  senza QApplication (programmi batch, benchmark, server senza display).
+*/
+
+#ifndef PAINTINGCATALOG_H
+#define PAINTINGCATALOG_H
+
+#include <QHash>
+#include <QIODevice>
+#include "dipinto.h"
+#include "facet_index.hpp"
+#include "selection.hpp"
+#include "versioned_set.hpp"
+
+/**
+    @brief classe PaintingCatalog
+
+    Contiene i dipinti in un versioned_set e li identifica tramite i suoi handle stabili.
+    filtra e validi restituiscono una selection (insieme compresso di handle),
+    combinabile con &, | e - senza copiare i dipinti; ordina ne ricava una
+    selezione, cioè un vettore di handle nell'ordine delle righe della tabella.
+
+    Per scuola, secolo e sala il catalogo mantiene un facet_index, aggiornato
+    a ogni modifica: i conteggi di una selection usano gli indici invece di
+    leggere i dipinti.
+
+    Le modifiche vanno fatte da un solo thread; snapshot() fornisce ad altri
+    thread una versione immutabile del catalogo da leggere mentre le modifiche continuano.
+*/
+class PaintingCatalog {
+public:
+    typedef versioned_set<dipinto, dipinto::equal_dipinto> collezione;
+    typedef collezione::snapshot_type snapshot_type;
+    typedef collezione::handle_type handle_type;
+    typedef collezione::size_type size_type;
+    typedef QVector<handle_type> selezione;
+
+    static const handle_type npos = collezione::npos;
+
+    /// handle toccati da reload: i rimossi non sono più validi, gli aggiunti possono riusarli
+    struct modifiche {
+        QVector<handle_type> rimossi;
+        QVector<handle_type> aggiunti;
+    };
+
+    bool load(const QString &path);
+    bool load(QIODevice &device);
+
+    /**
+        @brief Funzione che rilegge i file sorgente e applica al catalogo solo le differenze
+        rispetto ai dipinti letti dai file in precedenza (load o reload).
+        I dipinti inseriti con add restano nel catalogo; quelli tolti con remove
+        ritornano se sono ancora presenti nei file.
+        Le righe non cambiate costano solo la divisione in campi e l'impronta:
+        dipinti e indici si aggiornano solo per le righe aggiunte e tolte.
+
+        @param paths file CSV da rileggere
+        @param delta handle dei dipinti rimossi e aggiunti
+
+        @return false se un file non può essere letto o non ha intestazione (vuoto o troncato),
+        in tal caso il catalogo non cambia
+    */
+    bool reload(const QStringList &paths, modifiche &delta);
+
+    /**
+        @brief Funzione che restituisce la descrizione dell'ultimo errore di lettura
+
+        @return messaggio di errore, vuoto se l'ultima load è andata a buon fine
+    */
+    QString errorString() const {
+        return _errore;
+    }
+
+    /**
+        @brief Funzione che restituisce i nomi delle colonne letti dalla prima riga del CSV
+
+        @return intestazione del CSV
+    */
+    QStringList intestazione() const {
+        return _intestazione;
+    }
+
+    size_type size() const {
+        return _dipinti.getNumElements();
+    }
+
+    const dipinto &at(handle_type h) const {
+        return _dipinti.at(h);
+    }
+
+    handle_type find(const dipinto &d) const {
+        QHash<dipinto, handle_type>::const_iterator i = _indice.constFind(d);
+        PROFILO_CONTA(SONDE, 1);
+        // le impronte a 64 bit rendono trascurabili le collisioni: un confronto se il dipinto c'è
+        PROFILO_CONTA(CONFRONTI, i != _indice.constEnd());
+
+        return i != _indice.constEnd() ? i.value() : npos;
+    }
+
+    const collezione &elementi() const {
+        return _dipinti;
+    }
+
+    /**
+        @brief Funzione che restituisce la versione corrente del catalogo.
+        Può essere letta da qualunque thread. Una selection vale nello snapshot
+        solo se sono presi insieme, senza modifiche in mezzo (un remove invalida
+        i suoi handle): MainWindow::refresh li prende uno dopo l'altro nel thread
+        della GUI, che è l'unico a modificare il catalogo.
+
+        @return versione immutabile del catalogo
+    */
+    snapshot_type snapshot() const {
+        return _dipinti.snapshot();
+    }
+
+    /**
+        @brief Funzione che restituisce la selection di tutti i dipinti,
+        universo per il complemento di una selection (validi() - sel)
+
+        @return selection di tutti gli handle validi
+    */
+    selection validi() const {
+        return seleziona_tutti(_dipinti);
+    }
+
+    /**
+        @brief Funzione che seleziona i dipinti con titolo simile a quello cercato,
+        senza ordinarli per pertinenza
+
+        @param titolo titolo cercato
+
+        @return selection dei dipinti trovati
+    */
+    selection filtra(const QString &titolo) const;
+
+    /**
+        @brief Funzione che mette in ordine i dipinti di una selection per le righe della tabella:
+        per numero di errori crescente rispetto al titolo cercato, a parità per handle.
+        La distanza viene calcolata solo per i dipinti selezionati.
+
+        @param sel dipinti da ordinare
+        @param titolo titolo cercato, se vuoto l'ordine è quello degli handle
+
+        @return handle dei dipinti in ordine
+    */
+    selezione ordina(const selection &sel, const QString &titolo = QString()) const;
+
+    /**
+        @brief Funzioni che contano i dipinti di una selection per categoria tramite gli indici.
+        Leggono lo stato corrente, quindi vanno chiamate dal thread che modifica il catalogo.
+
+        @param sel dipinti da contare
+
+        @return mappa categoria -> numero di dipinti selezionati
+    */
+    QMap<QString, int> perScuola(const selection &sel) const {
+        return _scuole.counts(sel);
+    }
+
+    QMap<QString, int> perSecolo(const selection &sel) const {
+        return _secoli.counts(sel);
+    }
+
+    QMap<QString, int> perSala(const selection &sel) const {
+        return _sale.counts(sel);
+    }
+
+    handle_type add(const dipinto &d);
+    bool remove(handle_type h);
+    void clear();
+
+private:
+    handle_type inserisci(const dipinto &d);
+    void indicizza(handle_type h);
+    void togli(handle_type h);
+
+    collezione _dipinti;
+    facet_index<dipinto, dipinto::chiave_scuola> _scuole;
+    facet_index<dipinto, dipinto::chiave_secolo> _secoli;
+    facet_index<dipinto, dipinto::chiave_sala> _sale;
+    // trigrammi dei titoli normalizzati, per scartare i candidati di filtra
+    indice_trigrammi _titoli;
+    // tutti i dipinti del catalogo, anche quelli inseriti a mano, e il loro handle
+    QHash<dipinto, handle_type> _indice;
+    // impronta dei dipinti letti dai file e loro handle, per il confronto di reload
+    // (con impronte a 64 bit le collisioni tra righe diverse sono trascurabili)
+    QHash<quint64, handle_type> _caricati;
+    QStringList _intestazione;
+    QString _errore;
+};
+
+#endif // PAINTINGCATALOG_H
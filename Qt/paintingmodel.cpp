@@ -0,0 +1,90 @@
+#include "paintingmodel.h"
+#include "profilo.h"
+
+
+PaintingModel::PaintingModel(const PaintingCatalog &catalogo, QObject *parent) : QAbstractTableModel(parent), _catalogo(catalogo) {
+}
+
+
+int PaintingModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : _righe.size();
+}
+
+
+int PaintingModel::columnCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : 5;
+}
+
+
+QVariant PaintingModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || role != Qt::DisplayRole || index.row() >= _righe.size())
+        return QVariant();
+
+    const dipinto &d = _catalogo.at(_righe[index.row()]);
+
+    switch (index.column()) {
+    case 0: return d.getScuola();
+    case 1: return d.getAutore();
+    case 2: return d.getTitolo();
+    case 3: return d.getData();
+    case 4: return d.getSala();
+    }
+
+    return QVariant();
+}
+
+
+QVariant PaintingModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation == Qt::Horizontal && role == Qt::DisplayRole && section < _catalogo.intestazione().size())
+        return _catalogo.intestazione().at(section);
+
+    return QAbstractTableModel::headerData(section, orientation, role);
+}
+
+
+bool PaintingModel::removeRows(int row, int count, const QModelIndex &parent) {
+    if (parent.isValid() || row < 0 || count <= 0 || row + count > _righe.size())
+        return false;
+
+    beginRemoveRows(QModelIndex(), row, row + count - 1);
+    _righe.remove(row, count);
+    endRemoveRows();
+
+    return true;
+}
+
+
+void PaintingModel::setRighe(const PaintingCatalog::selezione &righe) {
+    beginResetModel();
+    _righe = righe;
+    endResetModel();
+
+    PROFILO_CONTA(RIGHE, righe.size());
+}
+
+
+void PaintingModel::appendRighe(const PaintingCatalog::selezione &righe) {
+    if (righe.isEmpty())
+        return;
+
+    beginInsertRows(QModelIndex(), _righe.size(), _righe.size() + righe.size() - 1);
+    _righe += righe;
+    endInsertRows();
+
+    PROFILO_CONTA(RIGHE, righe.size());
+}
+
+
+void PaintingModel::removeHandles(const selection &sel) {
+    // dal fondo, togliendo insieme le righe consecutive
+    for (int row = _righe.size() - 1; row >= 0; --row) {
+        if (!sel.contains(_righe[row]))
+            continue;
+
+        int fine = row;
+        while (row > 0 && sel.contains(_righe[row - 1]))
+            --row;
+
+        removeRows(row, fine - row + 1);
+    }
+}
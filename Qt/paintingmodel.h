@@ -0,0 +1,72 @@
+/**
+  @file paintingmodel.h
+
+  @brief File header della classe PaintingModel
+
+  Modello della tabella dei dipinti: le righe sono handle del catalogo
+  e i testi vengono letti dal catalogo solo quando la vista li disegna.
+*/
+
+#ifndef PAINTINGMODEL_H
+#define PAINTINGMODEL_H
+
+#include <QAbstractTableModel>
+#include "paintingcatalog.h"
+
+/**
+    @brief classe PaintingModel
+
+    Ogni riga contiene solo l'handle del dipinto (4 byte), nell'ordine
+    scelto da PaintingCatalog::ordina; la vista chiede a data() le sole
+    celle visibili, quindi una ricerca con molti risultati non crea
+    né copia le stringhe dei dipinti.
+
+    Il catalogo deve restare valido per tutta la vita del modello e
+    va modificato dallo stesso thread che usa il modello.
+*/
+class PaintingModel : public QAbstractTableModel {
+    Q_OBJECT
+
+    const PaintingCatalog &_catalogo;
+    PaintingCatalog::selezione _righe;
+
+public:
+    explicit PaintingModel(const PaintingCatalog &catalogo, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    bool removeRows(int row, int count, const QModelIndex &parent = QModelIndex()) override;
+
+    /**
+        @brief Funzione che sostituisce tutte le righe
+
+        @param righe handle dei dipinti in ordine di riga
+    */
+    void setRighe(const PaintingCatalog::selezione &righe);
+
+    /**
+        @brief Funzione che aggiunge righe in fondo alla tabella
+
+        @param righe handle dei dipinti da aggiungere
+    */
+    void appendRighe(const PaintingCatalog::selezione &righe);
+
+    /**
+        @brief Funzione che toglie le righe dei dipinti selezionati, in un solo passaggio
+
+        @param sel handle da togliere
+    */
+    void removeHandles(const selection &sel);
+
+    PaintingCatalog::handle_type handleAt(int row) const {
+        return _righe[row];
+    }
+
+    int rowOf(PaintingCatalog::handle_type h) const {
+        return _righe.indexOf(h);
+    }
+};
+
+#endif // PAINTINGMODEL_H
@@ -0,0 +1,153 @@
+#include "profilo.h"
+
+#ifdef DIPINTI_PROFILO
+
+#include <QLoggingCategory>
+#include <QThread>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+
+Q_LOGGING_CATEGORY(lcProfilo, "dipinti.profilo", QtInfoMsg)
+
+namespace profilo {
+
+std::atomic<unsigned long long> contatori[NUM_CONTATORI];
+
+namespace {
+
+// numero massimo di eventi conservati per il trace: oltre, i più vecchi vengono sovrascritti
+const size_t MAX_EVENTI = 1 << 16;
+
+struct evento {
+    const char *nome;
+    long long inizio_us;
+    long long durata_us;
+    unsigned long long thread;
+};
+
+// testa della lista delle sezioni registrate
+std::atomic<sezione*> sezioni(nullptr);
+
+struct registro {
+    // protegge solo il buffer del trace, usato quando DIPINTI_TRACE è impostata
+    std::mutex mutex;
+    std::vector<evento> eventi;
+    unsigned long long scritti;
+    std::string file_trace;
+    std::chrono::steady_clock::time_point origine;
+
+    registro() : scritti(0), origine(std::chrono::steady_clock::now()) {
+        const char *path = std::getenv("DIPINTI_TRACE");
+        if (path && *path) {
+            file_trace = path;
+            eventi.resize(MAX_EVENTI);
+            std::atexit(scriviTrace);
+        }
+    }
+
+    static void scriviTrace();
+};
+
+
+// il registro non viene mai distrutto, così resta valido per scriviTrace all'uscita
+registro &istanza() {
+    static registro *r = new registro;
+    return *r;
+}
+
+
+// formato Chrome trace: un evento completo ("ph":"X") per ogni scope misurato
+void registro::scriviTrace() {
+    registro &r = istanza();
+    std::lock_guard<std::mutex> lock(r.mutex);
+
+    FILE *out = std::fopen(r.file_trace.c_str(), "w");
+    if (!out)
+        return;
+
+    // eventi in ordine di registrazione, a partire dal più vecchio ancora nel buffer
+    unsigned long long primo = r.scritti > MAX_EVENTI ? r.scritti - MAX_EVENTI : 0;
+
+    std::fprintf(out, "{\"traceEvents\":[");
+    for (unsigned long long i = primo; i < r.scritti; ++i) {
+        const evento &e = r.eventi[i % MAX_EVENTI];
+        std::fprintf(out, "%s\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%llu,\"ts\":%lld,\"dur\":%lld}",
+                     i > primo ? "," : "", e.nome, e.thread, e.inizio_us, e.durata_us);
+    }
+
+    // i contatori finali come eventi di tipo counter
+    std::fprintf(out, "%s\n{\"name\":\"contatori\",\"ph\":\"C\",\"pid\":1,\"ts\":0,\"args\":"
+                      "{\"sonde\":%llu,\"confronti\":%llu,\"blocchi_copiati\":%llu,\"riallocazioni\":%llu,"
+                      "\"byte_copiati\":%llu,\"righe\":%llu}}",
+                 r.scritti == primo ? "" : ",", valore(SONDE), valore(CONFRONTI), valore(BLOCCHI_COPIATI),
+                 valore(RIALLOCAZIONI), valore(BYTE_COPIATI), valore(RIGHE));
+    std::fprintf(out, "\n]}\n");
+    std::fclose(out);
+}
+
+} // namespace
+
+
+unsigned long long valore(contatore c) {
+    return contatori[c].load(std::memory_order_relaxed);
+}
+
+
+sezione::sezione(const char *nome) : _nome(nome), _chiamate(0), _ns_totali(0), _ns_ultima(0) {
+    // inserimento in testa alla lista senza lock
+    _successiva = sezioni.load(std::memory_order_relaxed);
+    while (!sezioni.compare_exchange_weak(_successiva, this, std::memory_order_release, std::memory_order_relaxed))
+        ;
+}
+
+
+std::vector<statistica> statistiche() {
+    // più punti misurati con lo stesso nome vengono sommati
+    std::map<std::string, statistica> perNome;
+
+    for (sezione *s = sezioni.load(std::memory_order_acquire); s; s = s->_successiva) {
+        unsigned long long chiamate = s->_chiamate.load(std::memory_order_relaxed);
+        if (chiamate == 0)
+            continue;
+
+        statistica &st = perNome[s->_nome];
+        st.nome = s->_nome;
+        st.chiamate += chiamate;
+        st.ms_totali += s->_ns_totali.load(std::memory_order_relaxed) / 1e6;
+        st.ms_ultima = s->_ns_ultima.load(std::memory_order_relaxed) / 1e6;
+    }
+
+    std::vector<statistica> result;
+    for (const auto &s : perNome)
+        result.push_back(s.second);
+
+    return result;
+}
+
+
+scope::~scope() {
+    std::chrono::steady_clock::time_point fine = std::chrono::steady_clock::now();
+    long long ns = std::chrono::duration_cast<std::chrono::nanoseconds>(fine - _inizio).count();
+    _sezione.registra(ns);
+
+    registro &r = istanza();
+    if (!r.file_trace.empty()) {
+        evento e;
+        e.nome = _sezione.nome();
+        e.inizio_us = std::chrono::duration_cast<std::chrono::microseconds>(_inizio - r.origine).count();
+        e.durata_us = ns / 1000;
+        e.thread = reinterpret_cast<quintptr>(QThread::currentThreadId());
+
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.eventi[r.scritti % MAX_EVENTI] = e;
+        ++r.scritti;
+    }
+
+    qCDebug(lcProfilo, "%s: %.3f ms", _sezione.nome(), ns / 1e6);
+}
+
+} // namespace profilo
+
+#endif // DIPINTI_PROFILO
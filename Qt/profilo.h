@@ -0,0 +1,132 @@
+/**
+  @file profilo.h
+
+  @brief Misura dei tempi e contatori dei percorsi critici
+
+  Con DIPINTI_PROFILO definito (default, vedi catalog.pri) le macro
+  PROFILO_SCOPE e PROFILO_CONTA registrano durate e contatori;
+  con CONFIG+=no_profilo le macro si espandono a nulla e non hanno costo.
+
+  I dati sono consultabili da codice (statistiche, valore), nel log della
+  categoria "dipinti.profilo" (QT_LOGGING_RULES="dipinti.profilo.debug=true")
+  e, se la variabile d'ambiente DIPINTI_TRACE contiene un percorso, in un file
+  JSON in formato Chrome trace scritto all'uscita (apribile con Perfetto).
+  Il trace conserva gli ultimi 65536 eventi.
+
+  L'header non dipende da Qt perché è incluso da set.hpp.
+*/
+
+#ifndef PROFILO_H
+#define PROFILO_H
+
+#ifdef DIPINTI_PROFILO
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <vector>
+
+namespace profilo {
+
+enum contatore {
+    SONDE,           // ricerche di un dipinto nell'indice hash del catalogo
+    CONFRONTI,       // confronti di uguaglianza tra elementi (set, versioned_set, indice del catalogo)
+    BLOCCHI_COPIATI, // blocchi di persistent_array copiati perché condivisi con una versione
+    RIALLOCAZIONI,   // riallocazioni dell'array del set e della tabella dei blocchi di persistent_array
+    BYTE_COPIATI,    // byte copiati da riallocazioni, copy constructor e copie di blocchi
+    RIGHE,           // righe della tabella create
+    NUM_CONTATORI
+};
+
+extern std::atomic<unsigned long long> contatori[NUM_CONTATORI];
+
+inline void conta(contatore c, unsigned long long n) {
+    contatori[c].fetch_add(n, std::memory_order_relaxed);
+}
+
+unsigned long long valore(contatore c);
+
+
+/**
+    @brief statistica di una sezione misurata
+*/
+struct statistica {
+    std::string nome;
+    unsigned long long chiamate;
+    double ms_totali;
+    double ms_ultima;
+};
+
+std::vector<statistica> statistiche();
+
+
+/**
+    @brief classe sezione
+
+    Dati di un punto misurato con PROFILO_SCOPE: ogni punto ha la sua sezione
+    statica, quindi registrare una durata costa tre operazioni atomiche, senza
+    lock e senza cercare il nome. Le sezioni si registrano alla prima esecuzione
+    in una lista senza lock letta da statistiche().
+*/
+class sezione {
+    const char *_nome;
+    std::atomic<unsigned long long> _chiamate;
+    std::atomic<long long> _ns_totali;
+    std::atomic<long long> _ns_ultima;
+    sezione *_successiva;
+
+    friend std::vector<statistica> statistiche();
+
+public:
+    explicit sezione(const char *nome);
+
+    sezione(const sezione &) = delete;
+    sezione& operator=(const sezione &) = delete;
+
+    const char *nome() const {
+        return _nome;
+    }
+
+    void registra(long long ns) {
+        _chiamate.fetch_add(1, std::memory_order_relaxed);
+        _ns_totali.fetch_add(ns, std::memory_order_relaxed);
+        _ns_ultima.store(ns, std::memory_order_relaxed);
+    }
+};
+
+
+/**
+    @brief classe scope
+
+    Misura il tempo trascorso tra costruzione e distruzione
+    e lo registra nella sezione passata al costruttore.
+*/
+class scope {
+    sezione &_sezione;
+    std::chrono::steady_clock::time_point _inizio;
+
+public:
+    explicit scope(sezione &s) : _sezione(s), _inizio(std::chrono::steady_clock::now()) {}
+    ~scope();
+
+    scope(const scope &) = delete;
+    scope& operator=(const scope &) = delete;
+};
+
+} // namespace profilo
+
+#define PROFILO_CONCAT_(a, b) a##b
+#define PROFILO_CONCAT(a, b) PROFILO_CONCAT_(a, b)
+#define PROFILO_SCOPE(nome) \
+    static profilo::sezione PROFILO_CONCAT(profilo_sezione_, __LINE__)(nome); \
+    profilo::scope PROFILO_CONCAT(profilo_scope_, __LINE__)(PROFILO_CONCAT(profilo_sezione_, __LINE__))
+#define PROFILO_CONTA(c, n) profilo::conta(profilo::c, (n))
+
+#else
+
+#define PROFILO_SCOPE(nome)
+#define PROFILO_CONTA(c, n)
+
+#endif // DIPINTI_PROFILO
+
+#endif // PROFILO_H
@@ -0,0 +1,172 @@
+#include "ricerca.h"
+#include <algorithm>
+#include <vector>
+
+
+QString normalizza(const QString &testo) {
+    QString decomposto = testo.normalized(QString::NormalizationForm_KD);
+    QString result;
+    result.reserve(decomposto.size());
+    bool spazio = true;
+
+    for (const QChar &ch : decomposto) {
+        // i segni diacritici separati dalla decomposizione vengono scartati
+        if (ch.category() == QChar::Mark_NonSpacing)
+            continue;
+
+        if (ch.isLetterOrNumber()) {
+            result.append(ch.toLower());
+            spazio = false;
+        } else if (!spazio) {
+            // punteggiatura e spazi diventano un unico spazio
+            result.append(QChar(' '));
+            spazio = true;
+        }
+    }
+
+    if (result.endsWith(QChar(' ')))
+        result.chop(1);
+
+    return result;
+}
+
+
+ricerca_approssimata::ricerca_approssimata(const QString &query) : _m(qMin(query.size(), 64)) {
+    for (int i = 0; i < 128; ++i)
+        _ascii[i] = 0;
+
+    // per ogni carattere della query il bit i indica che compare in posizione i
+    for (int i = 0; i < _m; ++i) {
+        QChar ch = query.at(i);
+        if (ch.unicode() < 128)
+            _ascii[ch.unicode()] |= quint64(1) << i;
+        else
+            _altri[ch] |= quint64(1) << i;
+    }
+}
+
+
+quint64 ricerca_approssimata::maschera(QChar ch) const {
+    if (ch.unicode() < 128)
+        return _ascii[ch.unicode()];
+
+    return _altri.value(ch, 0);
+}
+
+
+int ricerca_approssimata::distanza(const QString &testo) const {
+    if (_m == 0)
+        return 0;
+
+    const quint64 alto = quint64(1) << (_m - 1);
+    quint64 pv = ~quint64(0);
+    quint64 mv = 0;
+    int score = _m;
+    int migliore = _m;
+
+    // la prima riga della matrice è tutta a zero: la query può iniziare in qualunque punto del testo
+    for (const QChar &ch : testo) {
+        quint64 eq = maschera(ch);
+        quint64 xv = eq | mv;
+        quint64 xh = (((eq & pv) + pv) ^ pv) | eq;
+        quint64 ph = mv | ~(xh | pv);
+        quint64 mh = pv & xh;
+
+        if (ph & alto)
+            ++score;
+        else if (mh & alto)
+            --score;
+
+        ph <<= 1;
+        mh <<= 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+
+        if (score < migliore)
+            migliore = score;
+    }
+
+    return migliore;
+}
+
+
+// tre caratteri UTF-16 in una sola chiave
+static quint64 trigramma(const QString &testo, int i) {
+    return (quint64(testo.at(i).unicode()) << 32) | (quint64(testo.at(i + 1).unicode()) << 16) | testo.at(i + 2).unicode();
+}
+
+
+// trigrammi distinti di una chiave, ordinati
+static QVector<quint64> trigrammi(const QString &chiave) {
+    QVector<quint64> t;
+
+    for (int i = 0; i + 3 <= chiave.size(); ++i)
+        t.append(trigramma(chiave, i));
+
+    std::sort(t.begin(), t.end());
+    t.erase(std::unique(t.begin(), t.end()), t.end());
+
+    return t;
+}
+
+
+void indice_trigrammi::insert(unsigned int h, const QString &chiave) {
+    for (quint64 t : trigrammi(chiave)) {
+        QVector<unsigned int> &lista = _liste[t];
+        // gli handle nuovi sono quasi sempre i più grandi: l'inserimento è in coda
+        lista.insert(std::lower_bound(lista.begin(), lista.end(), h), h);
+    }
+}
+
+
+void indice_trigrammi::erase(unsigned int h, const QString &chiave) {
+    for (quint64 t : trigrammi(chiave)) {
+        auto i = _liste.find(t);
+        if (i == _liste.end())
+            continue;
+
+        QVector<unsigned int> &lista = i.value();
+        auto j = std::lower_bound(lista.begin(), lista.end(), h);
+        if (j != lista.end() && *j == h)
+            lista.erase(j);
+
+        if (lista.isEmpty())
+            _liste.erase(i);
+    }
+}
+
+
+bool indice_trigrammi::candidati(const QString &query, int errori, unsigned int bound, QVector<unsigned int> &candidati) const {
+    int m = qMin(query.size(), 64);
+    int soglia = m - 2 - 3 * errori;
+
+    candidati.clear();
+    if (soglia <= 0)
+        return false;
+
+    // per ogni chiave, numero di posizioni della query il cui trigramma compare nella chiave
+    std::vector<quint8> conteggi(bound, 0);
+    QVector<const QVector<unsigned int>*> liste;
+
+    for (int i = 0; i + 3 <= m; ++i) {
+        auto l = _liste.constFind(trigramma(query, i));
+        if (l == _liste.constEnd())
+            continue;
+
+        liste.append(&l.value());
+        for (unsigned int h : l.value())
+            ++conteggi[h];
+    }
+
+    for (const QVector<unsigned int> *l : liste)
+        for (unsigned int h : *l)
+            if (conteggi[h] >= soglia) {
+                candidati.append(h);
+                // ogni chiave viene restituita una volta sola
+                conteggi[h] = 0;
+            }
+
+    std::sort(candidati.begin(), candidati.end());
+
+    return true;
+}
@@ -0,0 +1,109 @@
+/**
+  @file ricerca.h
+
+  @brief Normalizzazione dei testi e ricerca approssimata
+
+  Funzioni di supporto alla ricerca per titolo: la chiave normalizzata
+  viene calcolata una sola volta per dipinto, un indice di trigrammi
+  scarta i titoli che non possono essere vicini alla query e la distanza
+  di edit dei rimanenti viene calcolata con l'algoritmo bit-parallelo di Myers.
+*/
+
+#ifndef RICERCA_H
+#define RICERCA_H
+
+#include <QString>
+#include <QHash>
+#include <QVector>
+
+/**
+    @brief Funzione che restituisce la chiave di ricerca di un testo
+
+    Il testo viene decomposto in NFKD, vengono eliminati i segni diacritici,
+    la punteggiatura diventa uno spazio, le lettere vengono portate in minuscolo
+    e gli spazi consecutivi vengono collassati.
+    Es. "Nozze di Caterina de' Medici" -> "nozze di caterina de medici"
+
+    @param testo testo da normalizzare
+
+    @return chiave normalizzata
+*/
+QString normalizza(const QString &testo);
+
+
+/**
+    @brief classe ricerca_approssimata
+
+    Calcola la minima distanza di edit tra una query e una qualunque
+    sottostringa di un testo (algoritmo di Myers, 1999).
+    Le colonne della matrice di programmazione dinamica sono codificate
+    nei bit di una parola a 64 bit, quindi ogni carattere del testo
+    costa un numero costante di operazioni.
+    Le query più lunghe di 64 caratteri vengono troncate.
+*/
+class ricerca_approssimata {
+    quint64 _ascii[128];
+    QHash<QChar, quint64> _altri;
+    int _m;
+
+    quint64 maschera(QChar ch) const;
+
+public:
+    explicit ricerca_approssimata(const QString &query = QString());
+
+    /**
+        @brief Funzione che restituisce la lunghezza della query
+
+        @return numero di caratteri della query usati nel confronto
+    */
+    int lunghezza() const {
+        return _m;
+    }
+
+    /**
+        @brief Funzione che calcola la distanza dalla sottostringa più vicina
+
+        @param testo testo in cui cercare (già normalizzato)
+
+        @return distanza di edit minima, 0 se la query è contenuta nel testo
+    */
+    int distanza(const QString &testo) const;
+};
+
+
+/**
+    @brief classe indice_trigrammi
+
+    Per ogni trigramma (tre caratteri consecutivi) delle chiavi normalizzate
+    contiene la lista ordinata degli handle delle chiavi che lo contengono.
+
+    Se la query (di m caratteri) compare in una chiave con al massimo k errori,
+    ogni errore distrugge al più 3 dei suoi m - 2 trigrammi, quindi almeno
+    m - 2 - 3k trigrammi della query compaiono nella chiave. Solo le chiavi
+    che raggiungono questa soglia devono essere confrontate con Myers.
+*/
+class indice_trigrammi {
+    QHash<quint64, QVector<unsigned int>> _liste;
+
+public:
+    void insert(unsigned int h, const QString &chiave);
+    void erase(unsigned int h, const QString &chiave);
+
+    void clear() {
+        _liste.clear();
+    }
+
+    /**
+        @brief Funzione che restituisce le chiavi che possono contenere la query con al massimo errori errori
+
+        @param query query normalizzata (vengono usati i primi 64 caratteri, come in ricerca_approssimata)
+        @param errori numero massimo di errori
+        @param bound limite superiore degli handle
+        @param candidati handle delle chiavi che superano la soglia, in ordine crescente
+
+        @return false se la query è troppo corta per scartare qualcosa: vanno controllate tutte le chiavi
+    */
+    bool candidati(const QString &query, int errori, unsigned int bound, QVector<unsigned int> &candidati) const;
+};
+
+#endif // RICERCA_H
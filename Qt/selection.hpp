@@ -0,0 +1,587 @@
+/**
+  @file selection.hpp
+
+  @brief File header della classe selection
+
+  Insieme compresso di handle: i filtri restituiscono una selection
+  invece di copiare gli elementi in un nuovo set.
+*/
+
+#ifndef SELECTION_HPP
+#define SELECTION_HPP
+
+#include <algorithm> // per std::lower_bound, std::set_intersection, ...
+#include <cassert>   // per assert
+#include <cstddef>   // per std::ptrdiff_t, std::size_t
+#include <cstdint>   // per std::uint16_t, std::uint32_t, std::uint64_t
+#include <iterator>  // per std::forward_iterator_tag, std::back_inserter
+#include <vector>    // per std::vector
+
+#if defined(_MSC_VER)
+#include <intrin.h> // per __popcnt64, _BitScanForward64
+#endif
+
+
+/**
+    @brief Funzione che conta i bit a 1 di una parola (istruzione popcnt se disponibile)
+*/
+inline unsigned int conta_bit(std::uint64_t x) {
+#if defined(__GNUC__)
+    return static_cast<unsigned int>(__builtin_popcountll(x));
+#elif defined(_MSC_VER) && defined(_M_X64)
+    return static_cast<unsigned int>(__popcnt64(x));
+#else
+    x = x - ((x >> 1) & 0x5555555555555555ULL);
+    x = (x & 0x3333333333333333ULL) + ((x >> 2) & 0x3333333333333333ULL);
+    x = (x + (x >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return static_cast<unsigned int>((x * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+
+/**
+    @brief Funzione che restituisce la posizione del bit a 1 meno significativo
+
+    @pre x != 0
+*/
+inline unsigned int primo_bit(std::uint64_t x) {
+    assert(x != 0);
+#if defined(__GNUC__)
+    return static_cast<unsigned int>(__builtin_ctzll(x));
+#elif defined(_MSC_VER) && defined(_M_X64)
+    unsigned long i;
+    _BitScanForward64(&i, x);
+    return static_cast<unsigned int>(i);
+#else
+    unsigned int i = 0;
+    while (!(x & 1)) {
+        x >>= 1;
+        ++i;
+    }
+    return i;
+#endif
+}
+
+
+/**
+    @brief classe selection
+
+    Insieme di handle di una collezione (set, versioned_set) con lo schema
+    dei roaring bitmap: gli handle sono divisi in blocchi di 65536 valori
+    consecutivi e sono memorizzati solo i blocchi non vuoti. Un blocco con al
+    massimo 4096 handle è un array ordinato di 16 bit (2 byte per handle),
+    uno più denso è una bitmap di 8 KB.
+
+    La memoria è quindi proporzionale agli handle selezionati e non alla
+    dimensione della collezione, e i conteggi di intersezioni (count_and)
+    costano in base ai blocchi effettivamente presenti. Le selection si
+    combinano con AND (&), OR (|) e differenza (-).
+
+    L'iterazione restituisce gli handle selezionati in ordine crescente.
+*/
+class selection {
+public:
+    typedef unsigned int size_type;
+    typedef unsigned int handle_type;
+
+private:
+    // oltre questo numero di valori un array occupa più di una bitmap
+    static const size_type MAX_ARRAY = 4096;
+    static const size_type PAROLE = 1024;
+
+    struct blocco {
+        std::uint32_t chiave;                // handle >> 16
+        size_type card;                      // valori nel blocco
+        std::vector<std::uint16_t> valori;   // ordinati, se il blocco è un array
+        std::vector<std::uint64_t> parole;   // PAROLE parole, se il blocco è una bitmap
+
+        explicit blocco(std::uint32_t k = 0) : chiave(k), card(0) {}
+
+        bool bitmap() const {
+            return !parole.empty();
+        }
+
+        bool contains(std::uint16_t v) const {
+            if (bitmap())
+                return (parole[v / 64] >> (v % 64)) & 1;
+
+            return std::binary_search(valori.begin(), valori.end(), v);
+        }
+
+        bool insert(std::uint16_t v) {
+            if (bitmap()) {
+                std::uint64_t bit = std::uint64_t(1) << (v % 64);
+                if (parole[v / 64] & bit)
+                    return false;
+                parole[v / 64] |= bit;
+            } else {
+                std::vector<std::uint16_t>::iterator i = std::lower_bound(valori.begin(), valori.end(), v);
+                if (i != valori.end() && *i == v)
+                    return false;
+                valori.insert(i, v);
+            }
+
+            ++card;
+            normalizza();
+            return true;
+        }
+
+        bool erase(std::uint16_t v) {
+            if (bitmap()) {
+                std::uint64_t bit = std::uint64_t(1) << (v % 64);
+                if (!(parole[v / 64] & bit))
+                    return false;
+                parole[v / 64] &= ~bit;
+            } else {
+                std::vector<std::uint16_t>::iterator i = std::lower_bound(valori.begin(), valori.end(), v);
+                if (i == valori.end() || *i != v)
+                    return false;
+                valori.erase(i);
+            }
+
+            --card;
+            normalizza();
+            return true;
+        }
+
+        // sceglie il formato più piccolo per card valori
+        void normalizza() {
+            if (!bitmap() && card > MAX_ARRAY) {
+                parole.assign(PAROLE, 0);
+                for (std::uint16_t v : valori)
+                    parole[v / 64] |= std::uint64_t(1) << (v % 64);
+                std::vector<std::uint16_t>().swap(valori);
+            } else if (bitmap() && card <= MAX_ARRAY) {
+                valori.reserve(card);
+                for (size_type w = 0; w < PAROLE; ++w)
+                    for (std::uint64_t p = parole[w]; p; p &= p - 1)
+                        valori.push_back(static_cast<std::uint16_t>(w * 64 + primo_bit(p)));
+                std::vector<std::uint64_t>().swap(parole);
+            }
+        }
+
+        // copia del blocco in forma di bitmap
+        std::vector<std::uint64_t> come_bitmap() const {
+            if (bitmap())
+                return parole;
+
+            std::vector<std::uint64_t> p(PAROLE, 0);
+            for (std::uint16_t v : valori)
+                p[v / 64] |= std::uint64_t(1) << (v % 64);
+            return p;
+        }
+
+        void da_bitmap(std::vector<std::uint64_t> p) {
+            card = 0;
+            for (std::uint64_t w : p)
+                card += conta_bit(w);
+            parole.swap(p);
+            valori.clear();
+            normalizza();
+        }
+
+        void da_array(std::vector<std::uint16_t> v) {
+            card = static_cast<size_type>(v.size());
+            valori.swap(v);
+            parole.clear();
+            normalizza();
+        }
+    };
+
+    std::vector<blocco> _blocchi; // ordinati per chiave, mai vuoti
+
+
+    std::vector<blocco>::iterator trova(std::uint32_t chiave) {
+        return std::lower_bound(_blocchi.begin(), _blocchi.end(), chiave,
+                                [](const blocco &b, std::uint32_t k) { return b.chiave < k; });
+    }
+
+    std::vector<blocco>::const_iterator trova(std::uint32_t chiave) const {
+        return std::lower_bound(_blocchi.begin(), _blocchi.end(), chiave,
+                                [](const blocco &b, std::uint32_t k) { return b.chiave < k; });
+    }
+
+
+    static size_type conta_comuni(const blocco &a, const blocco &b) {
+        if (a.bitmap() && b.bitmap()) {
+            size_type n = 0;
+            for (size_type w = 0; w < PAROLE; ++w)
+                n += conta_bit(a.parole[w] & b.parole[w]);
+            return n;
+        }
+
+        if (a.bitmap() || b.bitmap()) {
+            const blocco &arr = a.bitmap() ? b : a;
+            const blocco &bmp = a.bitmap() ? a : b;
+            size_type n = 0;
+            for (std::uint16_t v : arr.valori)
+                n += (bmp.parole[v / 64] >> (v % 64)) & 1;
+            return n;
+        }
+
+        // due array ordinati: fusione
+        size_type n = 0;
+        std::size_t i = 0, j = 0;
+        while (i < a.valori.size() && j < b.valori.size()) {
+            if (a.valori[i] < b.valori[j])
+                ++i;
+            else if (b.valori[j] < a.valori[i])
+                ++j;
+            else {
+                ++n;
+                ++i;
+                ++j;
+            }
+        }
+        return n;
+    }
+
+
+    static blocco interseca(const blocco &a, const blocco &b) {
+        blocco r(a.chiave);
+
+        if (a.bitmap() && b.bitmap()) {
+            std::vector<std::uint64_t> p(a.parole);
+            for (size_type w = 0; w < PAROLE; ++w)
+                p[w] &= b.parole[w];
+            r.da_bitmap(p);
+        } else {
+            // il risultato è al massimo grande quanto l'array
+            const blocco &arr = a.bitmap() ? b : a;
+            const blocco &altro = a.bitmap() ? a : b;
+            std::vector<std::uint16_t> v;
+            for (std::uint16_t x : arr.valori)
+                if (altro.contains(x))
+                    v.push_back(x);
+            r.da_array(v);
+        }
+
+        return r;
+    }
+
+
+    static blocco unisci(const blocco &a, const blocco &b) {
+        blocco r(a.chiave);
+
+        if (!a.bitmap() && !b.bitmap()) {
+            std::vector<std::uint16_t> v;
+            std::set_union(a.valori.begin(), a.valori.end(), b.valori.begin(), b.valori.end(), std::back_inserter(v));
+            r.da_array(v);
+        } else {
+            std::vector<std::uint64_t> p = a.come_bitmap();
+            if (b.bitmap()) {
+                for (size_type w = 0; w < PAROLE; ++w)
+                    p[w] |= b.parole[w];
+            } else
+                for (std::uint16_t v : b.valori)
+                    p[v / 64] |= std::uint64_t(1) << (v % 64);
+            r.da_bitmap(p);
+        }
+
+        return r;
+    }
+
+
+    static blocco sottrai(const blocco &a, const blocco &b) {
+        blocco r(a.chiave);
+
+        if (!a.bitmap()) {
+            std::vector<std::uint16_t> v;
+            for (std::uint16_t x : a.valori)
+                if (!b.contains(x))
+                    v.push_back(x);
+            r.da_array(v);
+        } else {
+            std::vector<std::uint64_t> p(a.parole);
+            if (b.bitmap()) {
+                for (size_type w = 0; w < PAROLE; ++w)
+                    p[w] &= ~b.parole[w];
+            } else
+                for (std::uint16_t v : b.valori)
+                    p[v / 64] &= ~(std::uint64_t(1) << (v % 64));
+            r.da_bitmap(p);
+        }
+
+        return r;
+    }
+
+public:
+    /**
+        @brief classe const_iterator
+
+        Iteratore in avanti sugli handle selezionati.
+    */
+    class const_iterator {
+        const selection *_sel;
+        std::size_t _blocco;
+        size_type _i;          // indice nell'array o parola della bitmap
+        std::uint64_t _resto;  // bit ancora da visitare della parola corrente
+
+        // posiziona l'iteratore sul primo valore del blocco corrente o dei successivi
+        void sistema() {
+            while (_blocco < _sel->_blocchi.size()) {
+                const blocco &b = _sel->_blocchi[_blocco];
+
+                if (!b.bitmap()) {
+                    if (_i < b.valori.size())
+                        return;
+                } else {
+                    while (_resto == 0 && ++_i < PAROLE)
+                        _resto = b.parole[_i];
+                    if (_resto)
+                        return;
+                }
+
+                // blocco finito: si passa al successivo
+                ++_blocco;
+                _i = 0;
+                _resto = 0;
+                if (_blocco < _sel->_blocchi.size() && _sel->_blocchi[_blocco].bitmap())
+                    _resto = _sel->_blocchi[_blocco].parole[0];
+            }
+        }
+
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef handle_type value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef const handle_type* pointer;
+        typedef handle_type reference;
+
+        const_iterator(const selection *sel, std::size_t b) : _sel(sel), _blocco(b), _i(0), _resto(0) {
+            if (_blocco < _sel->_blocchi.size()) {
+                if (_sel->_blocchi[_blocco].bitmap())
+                    _resto = _sel->_blocchi[_blocco].parole[0];
+                sistema();
+            }
+        }
+
+        handle_type operator*() const {
+            const blocco &b = _sel->_blocchi[_blocco];
+            handle_type basso = b.bitmap() ? _i * 64 + primo_bit(_resto) : b.valori[_i];
+
+            return (handle_type(b.chiave) << 16) | basso;
+        }
+
+        const_iterator &operator++() {
+            if (_sel->_blocchi[_blocco].bitmap())
+                _resto &= _resto - 1;
+            else
+                ++_i;
+
+            sistema();
+            return *this;
+        }
+
+        const_iterator operator++(int) {
+            const_iterator tmp(*this);
+            ++*this;
+            return tmp;
+        }
+
+        bool operator==(const const_iterator &other) const {
+            return _blocco == other._blocco && _i == other._i && _resto == other._resto;
+        }
+
+        bool operator!=(const const_iterator &other) const {
+            return !(*this == other);
+        }
+    };
+
+
+    void insert(handle_type h) {
+        std::uint32_t k = h >> 16;
+        std::vector<blocco>::iterator b = trova(k);
+
+        if (b == _blocchi.end() || b->chiave != k)
+            b = _blocchi.insert(b, blocco(k));
+
+        b->insert(static_cast<std::uint16_t>(h & 0xFFFF));
+    }
+
+    void erase(handle_type h) {
+        std::uint32_t k = h >> 16;
+        std::vector<blocco>::iterator b = trova(k);
+
+        if (b == _blocchi.end() || b->chiave != k)
+            return;
+
+        if (b->erase(static_cast<std::uint16_t>(h & 0xFFFF)) && b->card == 0)
+            _blocchi.erase(b);
+    }
+
+    bool contains(handle_type h) const {
+        std::uint32_t k = h >> 16;
+        std::vector<blocco>::const_iterator b = trova(k);
+
+        return b != _blocchi.end() && b->chiave == k && b->contains(static_cast<std::uint16_t>(h & 0xFFFF));
+    }
+
+    /**
+        @brief Funzione che restituisce il numero di handle selezionati
+
+        @return numero di handle selezionati
+    */
+    size_type count() const {
+        size_type n = 0;
+
+        for (const blocco &b : _blocchi)
+            n += b.card;
+
+        return n;
+    }
+
+    bool empty() const {
+        return _blocchi.empty();
+    }
+
+    void clear() {
+        _blocchi.clear();
+    }
+
+    /**
+        @brief Funzione che conta gli handle comuni con other senza creare la loro intersezione.
+        Visita solo i blocchi presenti in entrambe: il costo dipende dagli handle selezionati,
+        non dalla dimensione della collezione.
+
+        @param other selection con cui contare gli handle comuni
+
+        @return numero di handle selezionati in entrambe
+    */
+    size_type count_and(const selection &other) const {
+        size_type n = 0;
+        std::size_t i = 0, j = 0;
+
+        while (i < _blocchi.size() && j < other._blocchi.size()) {
+            if (_blocchi[i].chiave < other._blocchi[j].chiave)
+                ++i;
+            else if (other._blocchi[j].chiave < _blocchi[i].chiave)
+                ++j;
+            else
+                n += conta_comuni(_blocchi[i++], other._blocchi[j++]);
+        }
+
+        return n;
+    }
+
+    selection &operator&=(const selection &other) {
+        std::vector<blocco> r;
+        std::size_t i = 0, j = 0;
+
+        while (i < _blocchi.size() && j < other._blocchi.size()) {
+            if (_blocchi[i].chiave < other._blocchi[j].chiave)
+                ++i;
+            else if (other._blocchi[j].chiave < _blocchi[i].chiave)
+                ++j;
+            else {
+                blocco b = interseca(_blocchi[i++], other._blocchi[j++]);
+                if (b.card > 0)
+                    r.push_back(b);
+            }
+        }
+
+        _blocchi.swap(r);
+        return *this;
+    }
+
+    selection &operator|=(const selection &other) {
+        std::vector<blocco> r;
+        std::size_t i = 0, j = 0;
+
+        while (i < _blocchi.size() || j < other._blocchi.size()) {
+            if (j == other._blocchi.size() || (i < _blocchi.size() && _blocchi[i].chiave < other._blocchi[j].chiave))
+                r.push_back(_blocchi[i++]);
+            else if (i == _blocchi.size() || other._blocchi[j].chiave < _blocchi[i].chiave)
+                r.push_back(other._blocchi[j++]);
+            else
+                r.push_back(unisci(_blocchi[i++], other._blocchi[j++]));
+        }
+
+        _blocchi.swap(r);
+        return *this;
+    }
+
+    /// differenza: toglie gli handle selezionati in other (AND NOT)
+    selection &operator-=(const selection &other) {
+        std::vector<blocco> r;
+        std::size_t j = 0;
+
+        for (const blocco &a : _blocchi) {
+            while (j < other._blocchi.size() && other._blocchi[j].chiave < a.chiave)
+                ++j;
+
+            if (j < other._blocchi.size() && other._blocchi[j].chiave == a.chiave) {
+                blocco b = sottrai(a, other._blocchi[j]);
+                if (b.card > 0)
+                    r.push_back(b);
+            } else
+                r.push_back(a);
+        }
+
+        _blocchi.swap(r);
+        return *this;
+    }
+
+    const_iterator begin() const {
+        return const_iterator(this, 0);
+    }
+
+    const_iterator end() const {
+        return const_iterator(this, _blocchi.size());
+    }
+};
+
+
+inline selection operator&(selection a, const selection &b) {
+    return a &= b;
+}
+
+inline selection operator|(selection a, const selection &b) {
+    return a |= b;
+}
+
+inline selection operator-(selection a, const selection &b) {
+    return a -= b;
+}
+
+
+/**
+    @brief Funzione che seleziona gli elementi che soddisfano il predicato.
+    A differenza di filter_out non copia gli elementi: restituisce i loro handle.
+
+    @param st collezione da filtrare (set, versioned_set o una sua versione)
+    @param predicate predicato da soddisfare
+
+    @return selection degli handle degli elementi che soddisfano il predicato
+*/
+template <typename Collezione, typename Predicate>
+selection seleziona(const Collezione &st, const Predicate &predicate) {
+    selection sel;
+
+    for (typename Collezione::size_type i = 0; i < st.getNumElements(); ++i)
+        if (predicate(st[i]))
+            sel.insert(st.handle_at(i));
+
+    return sel;
+}
+
+
+/**
+    @brief Funzione che seleziona tutti gli elementi della collezione.
+    Serve anche da universo per il complemento: tutti - sel.
+
+    @param st collezione (set, versioned_set o una sua versione)
+
+    @return selection degli handle di tutti gli elementi
+*/
+template <typename Collezione>
+selection seleziona_tutti(const Collezione &st) {
+    selection sel;
+
+    for (typename Collezione::size_type i = 0; i < st.getNumElements(); ++i)
+        sel.insert(st.handle_at(i));
+
+    return sel;
+}
+
+#endif
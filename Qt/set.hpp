@@ -13,6 +13,8 @@
 #include <ostream>   // per std::ostream
 #include <cassert>   // per assert
 #include <fstream>   // per std::ofstream
+#include <vector>    // per std::vector
+#include "profilo.h" // per PROFILO_SCOPE e PROFILO_CONTA
 
 
 /**
@@ -24,12 +26,24 @@
     _array è un puntatore all'array dinamico che contiene gli elementi del set
     _eql è un funtore che indica l'uguaglianza tra due oggetti di tipo T
 
+    Ogni elemento riceve all'inserimento un handle stabile: a differenza
+    della posizione in _array (che cambia quando remove sposta l'ultimo
+    elemento nel buco) l'handle resta valido finché l'elemento non viene rimosso.
+    _handles associa posizione -> handle
+    _slots associa handle -> posizione (npos se l'handle è libero)
+    _liberi contiene gli handle rilasciati, riutilizzati dalle add successive
+
 */
 template <typename T, typename Equal> 
 class set {
 
 public:
     typedef unsigned int size_type; 
+
+    typedef unsigned int handle_type;
+
+    /// handle non valido, restituito da find se l'elemento non è presente
+    static const handle_type npos = static_cast<handle_type>(-1);
     
     typedef const T* const_iterator;
     
@@ -46,6 +60,9 @@ private:
     size_type _size;
     size_type _count;
     Equal _eql;
+    std::vector<handle_type> _handles;
+    std::vector<size_type> _slots;
+    std::vector<handle_type> _liberi;
 
 
     /** 
@@ -54,23 +71,61 @@ private:
         Metodo di supporto alle funzioni add e remove, serve a ridimensionare il 
         set per agevolare l'aggiunta e la rimozione di elementi.
         Prende in input la nuova dimensione del set e ridimensiona il set a quella dimensione
-        copiando gli elementi del vecchio set nel nuovo set.
+        copiando gli elementi del vecchio array nel nuovo.
+        Gli elementi sono già distinti, quindi vengono copiati direttamente
+        senza ripetere il controllo di appartenenza; posizioni e handle restano invariati.
 
         @param new_size nuova dimensione del set
 
+        @pre new_size >= _count
+
+        @throw std::bad_alloc possibile eccezione di allocazione
+
         @post _size == new_size
         @post tmp[i] = _array[i]
     */
     void resize(size_type new_size) {
-        // creo nuovo set con size elementi
-        set tmp(new_size);
-        
+        assert(new_size >= _count);
+
+        // creo nuovo array con new_size elementi
+        T *tmp = new T[new_size];
+
         // copio gli elementi
-        for (size_type i = 0; i < _count; ++i)
-            tmp.add(_array[i]);
+        try {
+            for (size_type i = 0; i < _count; ++i)
+                tmp[i] = _array[i];
+        }
+        catch(...) {
+            delete[] tmp;
+            throw;
+        }
+
+        PROFILO_CONTA(RIALLOCAZIONI, 1);
+        PROFILO_CONTA(BYTE_COPIATI, _count * sizeof(T));
+
+        // sostituisco _array con tmp
+        delete[] _array;
+        _array = tmp;
+        _size = new_size;
+    }
+
+
+    /**
+        @brief Funzione che restituisce un handle libero.
+        Riusa un handle rilasciato da remove se disponibile, 
+        altrimenti ne crea uno nuovo.
+
+        @return handle da assegnare al nuovo elemento
+    */
+    handle_type new_handle() {
+        if (!_liberi.empty()) {
+            handle_type h = _liberi.back();
+            _liberi.pop_back();
+            return h;
+        }
 
-        // sostituisco this con tmp
-        swap(tmp);
+        _slots.push_back(npos);
+        return static_cast<handle_type>(_slots.size() - 1);
     }
     
 public:
@@ -132,9 +187,16 @@ public:
             
             for (size_type i = 0; i < other._size; ++i)
                 _array[i] = other._array[i];
+
+            PROFILO_CONTA(RIALLOCAZIONI, 1);
+            PROFILO_CONTA(BYTE_COPIATI, other._size * sizeof(T));
             
             _size = other._size;
             _count = other._count;
+
+            _handles = other._handles;
+            _slots = other._slots;
+            _liberi = other._liberi;
         }
         catch(...) {
             // Se c'e' un problema, il set viene svuotato 
@@ -192,6 +254,9 @@ public:
         _array = nullptr;
         _size = 0;
         _count = 0;
+        _handles.clear();
+        _slots.clear();
+        _liberi.clear();
     }
     
 
@@ -210,6 +275,9 @@ public:
         std::swap(_count, other._count);
         std::swap(_array, other._array); 
         std::swap(_eql, other._eql);
+        _handles.swap(other._handles);
+        _slots.swap(other._slots);
+        _liberi.swap(other._liberi);
     }
 
 
@@ -251,22 +319,59 @@ public:
 
         @post _array[_count] == value
         @post _count == _count + 1
+        @post handle_at(_count - 1) è l'handle del nuovo elemento
 
     */
     bool add(const T &value) {
         if (contains(value))
             return false;
         
+        add_distinct(value);
+
+        return true;
+    }
+
+
+    /**
+        @brief Funzione che aggiunge un elemento senza controllarne la presenza
+
+        Usata quando l'unicità è già garantita dal chiamante
+        (es. concurrent_set::freeze), evita la scansione di contains.
+
+        @param value valore da aggiungere al set
+
+        @pre !contains(value)
+
+        @post _array[_count] == value
+        @post _count == _count + 1
+    */
+    void add_distinct(const T &value) {
         // ridimensionato il set se necessario
         if (_size == 0) 
             resize(1);
         else if(_count == _size)
             resize(2 * _size);
         
+        handle_type h = new_handle();
+        _handles.push_back(h);
+        _slots[h] = _count;
+
         _array[_count] = value;
         ++_count;
+    }
 
-        return true;
+
+    /**
+        @brief Funzione che riserva spazio per almeno n elementi,
+        evitando le riallocazioni successive fino a quella dimensione
+
+        @param n numero di elementi da poter contenere
+
+        @post _size >= n
+    */
+    void reserve(size_type n) {
+        if (n > _size)
+            resize(n);
     }
 
 
@@ -288,25 +393,117 @@ public:
         @post _count == _count - 1
     */
     bool remove(const T &value) {
-        if (!contains(value))
+        return remove_handle(find(value));
+    }
+
+
+    /**
+        @brief Funzione che rimuove l'elemento identificato da un handle in O(1)
+
+        Come remove, l'elemento viene sostituito con l'ultimo del set.
+        L'handle dell'elemento spostato non cambia, cambia solo la sua posizione.
+        L'handle rimosso diventa libero e potrà essere riassegnato da add.
+
+        @param h handle dell'elemento da rimuovere
+
+        @return true se l'elemento è stato rimosso, false se h non è valido
+
+        @post _count == _count - 1
+        @post !valid(h)
+    */
+    bool remove_handle(handle_type h) {
+        if (!valid(h))
             return false;
-        
-        // se l'elemento è presente, lo sostituisco con l'ultimo, il contatore viene aggiornato 
-        // e viene restituito true per non controllare il resto degli elementi
-        for (size_type i = 0; i < _count; ++i) {
-            if (_eql(value, _array[i])) {
-                _array[i] = _array[_count-1];
-                _count = _count - 1;
-                
-                // ridimensioniamo il set se necessario
-                if (_count <= _size / 2) 
-                    resize(_size * 3 / 4);
 
-                return true;
+        size_type i = _slots[h];
+        size_type last = _count - 1;
+
+        // sposto l'ultimo elemento nel buco insieme al suo handle
+        _array[i] = _array[last];
+        _handles[i] = _handles[last];
+        _slots[_handles[i]] = i;
+
+        _handles.pop_back();
+        _slots[h] = npos;
+        _liberi.push_back(h);
+        _count = last;
+
+        // ridimensioniamo il set se necessario
+        if (_count <= _size / 2) 
+            resize(_size * 3 / 4);
+
+        return true;
+    }
+
+
+    /**
+        @brief Funzione che restituisce l'handle dell'elemento uguale a value
+
+        @param value valore da cercare nel set
+
+        @return handle dell'elemento, npos se non è presente
+    */
+    handle_type find(const T &value) const {
+        for (size_type i = 0; i < _count; ++i)
+            if (_eql(value, _array[i])) {
+                PROFILO_CONTA(CONFRONTI, i + 1);
+                return _handles[i];
             }
-        }
 
-        return false;
+        PROFILO_CONTA(CONFRONTI, _count);
+        return npos;
+    }
+
+
+    /**
+        @brief Funzione che controlla se un handle identifica un elemento presente
+
+        @param h handle da controllare
+
+        @return true se h è associato ad un elemento del set
+    */
+    bool valid(handle_type h) const {
+        return h < _slots.size() && _slots[h] != npos;
+    }
+
+
+    /**
+        @brief Funzione che restituisce l'handle dell'elemento in posizione index
+
+        @param index posizione dell'elemento
+
+        @return handle dell'elemento
+    */
+    handle_type handle_at(const size_type index) const {
+        assert(index < _count);
+
+        return _handles[index];
+    }
+
+
+    /**
+        @brief Accesso in sola lettura all'elemento identificato da un handle in O(1)
+
+        @param h handle dell'elemento
+
+        @return reference all'elemento
+    */
+    const T& at(handle_type h) const {
+        assert(valid(h));
+
+        return _array[_slots[h]];
+    }
+
+
+    /**
+        @brief Funzione che restituisce il limite superiore degli handle assegnati.
+        Ogni handle valido è minore di questo valore, quindi può essere usato
+        per dimensionare strutture indicizzate per handle.
+
+        @return numero di handle assegnati (validi o liberi)
+    */
+    size_type handle_bound() const {
+        return static_cast<size_type>(_slots.size());
     }
 
 
@@ -361,9 +558,12 @@ public:
         // se non ci sono elementi, viene restituito false
      
         for (size_type i = 0; i < _count; ++i)
-            if (_eql(value, _array[i]))
+            if (_eql(value, _array[i])) {
+                PROFILO_CONTA(CONFRONTI, i + 1);
                 return true;
+            }
         
+        PROFILO_CONTA(CONFRONTI, _count);
         return false;
     }
 
@@ -389,6 +589,9 @@ public:
     }
 };
 
+template <typename T, typename Equal>
+const typename set<T, Equal>::handle_type set<T, Equal>::npos;
+
 /** 
     @brief Funzione che restituisce gli elementi del set che soddisfano il predicato
 
@@ -399,6 +602,7 @@ public:
 */
 template<typename T, typename Equal, typename Predicate>
 set<T, Equal> filter_out(const set<T, Equal> &st, const Predicate predicate) {
+    PROFILO_SCOPE("filter_out");
     typename set<T, Equal>::const_iterator i, ie;
 
     set<T, Equal> result;
@@ -490,4 +694,4 @@ void save(const set<std::string, Equal> &st, const std::string filename) {
 }
 
 
-#endif
\ No newline at end of file
+#endif
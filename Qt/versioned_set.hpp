@@ -0,0 +1,376 @@
+/**
+  @file versioned_set.hpp
+
+  @brief File header della classe versioned_set templata
+
+  Set con versioni immutabili (copy-on-write): un solo thread modifica,
+  un numero qualunque di thread legge snapshot che non cambiano mai.
+*/
+
+#ifndef VERSIONED_SET_HPP
+#define VERSIONED_SET_HPP
+
+#include <atomic>  // per std::atomic_thread_fence
+#include <cassert> // per assert
+#include <memory>  // per std::shared_ptr, std::atomic_load, std::atomic_store
+#include <vector>  // per std::vector
+#include "profilo.h"
+
+
+/**
+    @brief classe persistent_array
+
+    Array diviso in blocchi di B elementi condivisi tra le copie.
+    Copiare l'array copia solo i puntatori ai blocchi (size / B puntatori);
+    la scrittura di un elemento copia il suo blocco solo se è condiviso
+    con un'altra copia.
+*/
+template <typename V, unsigned int B = 256>
+class persistent_array {
+public:
+    typedef unsigned int size_type;
+
+private:
+    std::vector<std::shared_ptr<std::vector<V>>> _blocchi;
+    size_type _count;
+
+
+    /**
+        @brief Funzione che restituisce il blocco b pronto per essere modificato.
+        Se il blocco è condiviso con altre copie ne crea uno privato.
+        Se l'unico proprietario è questo array nessun altro può ottenerlo,
+        quindi il blocco può essere modificato sul posto.
+
+        use_count() è una lettura relaxed: il lettore che ha rilasciato l'ultima
+        versione precedente ha decrementato il contatore con una release, e la
+        fence acquire dopo aver visto il valore 1 ordina le sue letture del blocco
+        prima della scrittura sul posto (come Arc::get_mut in Rust).
+
+        @param b indice del blocco
+
+        @return reference al blocco modificabile
+    */
+    std::vector<V> &modificabile(size_type b) {
+        if (_blocchi[b].use_count() > 1) {
+            _blocchi[b] = std::make_shared<std::vector<V>>(*_blocchi[b]);
+            PROFILO_CONTA(BLOCCHI_COPIATI, 1);
+            PROFILO_CONTA(BYTE_COPIATI, _blocchi[b]->size() * sizeof(V));
+        } else
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+        return *_blocchi[b];
+    }
+
+public:
+    persistent_array() : _count(0) {}
+
+    size_type size() const {
+        return _count;
+    }
+
+    const V &operator[](size_type i) const {
+        assert(i < _count);
+
+        return (*_blocchi[i / B])[i % B];
+    }
+
+    void set(size_type i, const V &value) {
+        assert(i < _count);
+
+        modificabile(i / B)[i % B] = value;
+    }
+
+    void push_back(const V &value) {
+        if (_count % B == 0) {
+            if (_blocchi.size() == _blocchi.capacity()) {
+                PROFILO_CONTA(RIALLOCAZIONI, 1);
+                PROFILO_CONTA(BYTE_COPIATI, _blocchi.size() * sizeof(_blocchi[0]));
+            }
+            _blocchi.push_back(std::make_shared<std::vector<V>>());
+            _blocchi.back()->reserve(B);
+        }
+
+        modificabile(_count / B).push_back(value);
+        ++_count;
+    }
+
+    void pop_back() {
+        assert(_count > 0);
+
+        modificabile((_count - 1) / B).pop_back();
+        --_count;
+
+        if (_count % B == 0)
+            _blocchi.pop_back();
+    }
+
+    void clear() {
+        _blocchi.clear();
+        _count = 0;
+    }
+};
+
+
+/**
+    @brief classe versioned_set
+
+    Set di oggetti T con la stessa semantica di set (uguaglianza data da Equal,
+    handle stabili, rimozione per sostituzione con l'ultimo elemento),
+    in cui ogni modifica pubblica una nuova versione immutabile.
+
+    snapshot() restituisce l'ultima versione pubblicata: i lettori possono
+    scorrerla da qualunque thread mentre lo scrittore continua a modificare il set,
+    senza lock e senza vedere modifiche parziali. Solo lo scambio del puntatore
+    in snapshot() e publish() non è lock-free: std::atomic_load e std::atomic_store
+    su shared_ptr usano un lock breve (in libstdc++ un mutex preso da un pool globale),
+    tenuto per la sola copia del puntatore. Le versioni condividono i blocchi
+    non modificati, quindi una versione nuova costa size / 256 puntatori più
+    i blocchi effettivamente toccati, non la copia di tutti gli elementi.
+
+    Le funzioni che modificano il set devono essere chiamate da un solo thread.
+*/
+template <typename T, typename Equal>
+class versioned_set {
+public:
+    typedef unsigned int size_type;
+
+    typedef unsigned int handle_type;
+
+    /// handle non valido, restituito da find se l'elemento non è presente
+    static const handle_type npos = static_cast<handle_type>(-1);
+
+
+    /**
+        @brief classe version
+
+        Contenuto del set in un certo istante. Una versione pubblicata non viene
+        più modificata, quindi tutte le funzioni di lettura sono sicure tra thread.
+    */
+    class version {
+        friend class versioned_set;
+
+        persistent_array<T> _elementi;
+        persistent_array<handle_type> _handles;
+        persistent_array<size_type> _slots;
+        Equal _eql;
+
+    public:
+        size_type getNumElements() const {
+            return _elementi.size();
+        }
+
+        const T& operator[](const size_type index) const {
+            return _elementi[index];
+        }
+
+        handle_type handle_at(const size_type index) const {
+            return _handles[index];
+        }
+
+        bool valid(handle_type h) const {
+            return h < _slots.size() && _slots[h] != npos;
+        }
+
+        const T& at(handle_type h) const {
+            assert(valid(h));
+
+            return _elementi[_slots[h]];
+        }
+
+        size_type handle_bound() const {
+            return _slots.size();
+        }
+
+        handle_type find(const T &value) const {
+            for (size_type i = 0; i < _elementi.size(); ++i)
+                if (_eql(value, _elementi[i])) {
+                    PROFILO_CONTA(CONFRONTI, i + 1);
+                    return _handles[i];
+                }
+
+            PROFILO_CONTA(CONFRONTI, _elementi.size());
+            return npos;
+        }
+
+        bool contains(const T &value) const {
+            return find(value) != npos;
+        }
+    };
+
+    typedef std::shared_ptr<const version> snapshot_type;
+
+private:
+    version _corrente;
+    std::vector<handle_type> _liberi;
+    snapshot_type _pubblicata;
+
+public:
+    /**
+       @brief Costruttore di default, pubblica una versione vuota
+    */
+    versioned_set() : _pubblicata(std::make_shared<const version>()) {}
+
+    versioned_set(const versioned_set &other) = delete;
+    versioned_set& operator=(const versioned_set &other) = delete;
+
+
+    /**
+        @brief Funzione che restituisce l'ultima versione pubblicata.
+        Può essere chiamata da qualunque thread; prende un lock breve per copiare il puntatore,
+        poi la versione si legge senza sincronizzazione.
+
+        @return snapshot immutabile del set
+    */
+    snapshot_type snapshot() const {
+        return std::atomic_load(&_pubblicata);
+    }
+
+
+    /**
+        @brief Funzione che pubblica lo stato corrente come nuova versione.
+        Le versioni già distribuite ai lettori restano valide e invariate.
+    */
+    void publish() {
+        std::atomic_store(&_pubblicata, snapshot_type(std::make_shared<const version>(_corrente)));
+    }
+
+
+    /**
+        @brief Funzione che aggiunge un elemento al set
+
+        @param value valore da aggiungere al set
+        @param pubblica se false la versione non viene pubblicata
+                        (caricamenti di molti elementi seguiti da una sola publish)
+
+        @return true se l'elemento è stato aggiunto, false se era già presente
+    */
+    bool add(const T &value, bool pubblica = true) {
+        if (_corrente.contains(value))
+            return false;
+
+        add_distinct(value, pubblica);
+
+        return true;
+    }
+
+
+    /**
+        @brief Funzione che aggiunge un elemento senza controllarne la presenza
+
+        Usata quando l'unicità è già garantita dal chiamante (es. PaintingCatalog,
+        che tiene un indice hash dei dipinti), evita la scansione di contains.
+
+        @param value valore da aggiungere al set
+        @param pubblica se false la versione non viene pubblicata
+
+        @pre !contains(value)
+
+        @return handle del nuovo elemento
+    */
+    handle_type add_distinct(const T &value, bool pubblica = true) {
+        handle_type h;
+        if (!_liberi.empty()) {
+            h = _liberi.back();
+            _liberi.pop_back();
+            _corrente._slots.set(h, _corrente._elementi.size());
+        } else {
+            h = _corrente._slots.size();
+            _corrente._slots.push_back(_corrente._elementi.size());
+        }
+
+        _corrente._elementi.push_back(value);
+        _corrente._handles.push_back(h);
+
+        if (pubblica)
+            publish();
+
+        return h;
+    }
+
+
+    bool remove(const T &value, bool pubblica = true) {
+        return remove_handle(find(value), pubblica);
+    }
+
+
+    /**
+        @brief Funzione che rimuove l'elemento identificato da un handle.
+        Come in set, l'ultimo elemento prende il posto di quello rimosso.
+
+        @param h handle dell'elemento da rimuovere
+        @param pubblica se false la versione non viene pubblicata
+
+        @return true se l'elemento è stato rimosso, false se h non è valido
+    */
+    bool remove_handle(handle_type h, bool pubblica = true) {
+        if (!valid(h))
+            return false;
+
+        size_type i = _corrente._slots[h];
+        size_type last = _corrente._elementi.size() - 1;
+
+        if (i != last) {
+            handle_type spostato = _corrente._handles[last];
+            _corrente._elementi.set(i, _corrente._elementi[last]);
+            _corrente._handles.set(i, spostato);
+            _corrente._slots.set(spostato, i);
+        }
+
+        _corrente._elementi.pop_back();
+        _corrente._handles.pop_back();
+        _corrente._slots.set(h, npos);
+        _liberi.push_back(h);
+
+        if (pubblica)
+            publish();
+
+        return true;
+    }
+
+
+    void empty() {
+        _corrente = version();
+        _liberi.clear();
+        publish();
+    }
+
+
+    // letture sullo stato corrente, riservate al thread che modifica il set
+
+    size_type getNumElements() const {
+        return _corrente.getNumElements();
+    }
+
+    const T& operator[](const size_type index) const {
+        return _corrente[index];
+    }
+
+    handle_type handle_at(const size_type index) const {
+        return _corrente.handle_at(index);
+    }
+
+    bool valid(handle_type h) const {
+        return _corrente.valid(h);
+    }
+
+    const T& at(handle_type h) const {
+        return _corrente.at(h);
+    }
+
+    size_type handle_bound() const {
+        return _corrente.handle_bound();
+    }
+
+    handle_type find(const T &value) const {
+        return _corrente.find(value);
+    }
+
+    bool contains(const T &value) const {
+        return _corrente.contains(value);
+    }
+};
+
+template <typename T, typename Equal>
+const typename versioned_set<T, Equal>::handle_type versioned_set<T, Equal>::npos;
+
+#endif